@@ -1,6 +1,7 @@
 #include "Arduino.h"
 #include "Adafruit_LiquidCrystal.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 
@@ -9,6 +10,12 @@
 #	define _BV(bit) (1 << (bit))
 #endif 
 
+// cursor positions that are not a cell of the shadow
+#define LCD_POS_UNKNOWN 0xFF
+#define LCD_POS_CGRAM 0xFE
+
+static const uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
+
 
 // When the display powers up, it is configured as follows:
 //
@@ -57,6 +64,8 @@ Adafruit_LiquidCrystal::Adafruit_LiquidCrystal(uint8_t rs,  uint8_t enable,
 
 Adafruit_LiquidCrystal::Adafruit_LiquidCrystal(uint8_t i2caddr) {
   _i2cAddr = i2caddr;
+  _i2cfill = 0;
+  _shadow = NULL;
 
   _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
   
@@ -75,6 +84,8 @@ Adafruit_LiquidCrystal::Adafruit_LiquidCrystal(uint8_t i2caddr) {
 
 Adafruit_LiquidCrystal::Adafruit_LiquidCrystal(uint8_t data, uint8_t clock, uint8_t latch ) {
   _i2cAddr = 255;
+  _i2cfill = 0;
+  _shadow = NULL;
 
   _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
   
@@ -115,7 +126,9 @@ void Adafruit_LiquidCrystal::init(uint8_t fourbitmode, uint8_t rs, uint8_t rw, u
   _data_pins[7] = d7; 
 
   _i2cAddr = 255;
+  _i2cfill = 0;
   _SPIclock = _SPIdata = _SPIlatch = 255;
+  _shadow = NULL;
 
   if (fourbitmode)
     _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
@@ -157,7 +170,12 @@ void Adafruit_LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize)
     _displayfunction |= LCD_2LINE;
   }
   _numlines = lines;
+  _numcols = cols;
   _currline = 0;
+  _col = LCD_POS_UNKNOWN;
+
+  free(_shadow);
+  _shadow = (uint8_t *)malloc(cols * lines);
 
   // for some 1 line displays you can select a 10 pixel high font
   if ((dotsize != 0) && (lines == 1)) {
@@ -182,18 +200,22 @@ void Adafruit_LiquidCrystal::begin(uint8_t cols, uint8_t lines, uint8_t dotsize)
 
     // we start in 8bit mode, try to set 4 bit mode
     write4bits(0x03);
+    _i2cFlush();
     delayMicroseconds(4500); // wait min 4.1ms
 
     // second try
     write4bits(0x03);
+    _i2cFlush();
     delayMicroseconds(4500); // wait min 4.1ms
     
     // third go!
     write4bits(0x03); 
+    _i2cFlush();
     delayMicroseconds(150);
 
     // finally, set to 8-bit interface
     write4bits(0x02); 
+    _i2cFlush();
   } else {
     // this is according to the hitachi HD44780 datasheet
     // page 45 figure 23
@@ -232,22 +254,46 @@ void Adafruit_LiquidCrystal::clear()
 {
   command(LCD_CLEARDISPLAY);  // clear display, set cursor position to zero
   delayMicroseconds(2000);  // this command takes a long time!
+  if (_shadow)
+    memset(_shadow, ' ', _numcols * _numlines);
+  _col = _row = 0;
 }
 
 void Adafruit_LiquidCrystal::home()
 {
   command(LCD_RETURNHOME);  // set cursor position to zero
   delayMicroseconds(2000);  // this command takes a long time!
+  _col = _row = 0;
 }
 
 void Adafruit_LiquidCrystal::setCursor(uint8_t col, uint8_t row)
 {
-  int row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
   if ( row > _numlines ) {
     row = _numlines-1;    // we count rows starting w/0
   }
   
   command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
+  _col = col;
+  _row = row;
+}
+
+void Adafruit_LiquidCrystal::printLine(uint8_t row, const char *text)
+{
+  if (row >= _numlines)
+    return;
+  uint8_t *cells = _shadow ? _shadow + row * _numcols : NULL;
+  for (uint8_t col = 0; col < _numcols; col++) {
+    uint8_t c = *text ? *text++ : ' ';
+    if (cells && cells[col] == c)
+      continue;
+    if (_col != col || _row != row) {
+      send(LCD_SETDDRAMADDR | (col + row_offsets[row]), LOW);
+      _col = col;
+      _row = row;
+    }
+    send(c, HIGH);
+  }
+  _i2cFlush();
 }
 
 // Turn the display on/off (quickly)
@@ -326,16 +372,27 @@ void Adafruit_LiquidCrystal::createChar(uint8_t location, uint8_t charmap[]) {
 
 inline void Adafruit_LiquidCrystal::command(uint8_t value) {
   send(value, LOW);
+  _i2cFlush();
 }
 
 #if ARDUINO >= 100
 inline size_t Adafruit_LiquidCrystal::write(uint8_t value) {
   send(value, HIGH);
+  _i2cFlush();
   return 1;
 }
+
+// a whole string goes out in as few I2C transactions as possible
+size_t Adafruit_LiquidCrystal::write(const uint8_t *buffer, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    send(buffer[i], HIGH);
+  _i2cFlush();
+  return size;
+}
 #else
 inline void Adafruit_LiquidCrystal::write(uint8_t value) {
   send(value, HIGH);
+  _i2cFlush();
 }
 #endif
 
@@ -345,6 +402,7 @@ inline void Adafruit_LiquidCrystal::write(uint8_t value) {
 void  Adafruit_LiquidCrystal::_digitalWrite(uint8_t p, uint8_t d) {
   if (_i2cAddr != 255) {
     // an i2c command
+    _i2cFlush();
     _i2c.digitalWrite(p, d);
   } else if (_SPIclock != 255) {
     if (d == HIGH)
@@ -384,6 +442,21 @@ void  Adafruit_LiquidCrystal::_pinMode(uint8_t p, uint8_t d) {
 
 // write either command or data, with automatic 4/8-bit selection
 void Adafruit_LiquidCrystal::send(uint8_t value, boolean mode) {
+  track(value, mode);
+
+  if (_i2cAddr != 255) {
+    // queue the output states, RS must settle before enable rises
+    uint8_t out = _i2cOutput();
+    uint8_t rs = mode ? out | _BV(_rs_pin) : out & ~_BV(_rs_pin);
+    if (rs != out)
+      _i2cPush(rs);
+    write4bits(value>>4);
+    write4bits(value);
+    // one more byte time, so that the next nibble comes after > 37us
+    _i2cPush(_i2cOutput());
+    return;
+  }
+
   _digitalWrite(_rs_pin, mode);
 
   // if there is a RW pin indicated, set it low to Write
@@ -399,6 +472,48 @@ void Adafruit_LiquidCrystal::send(uint8_t value, boolean mode) {
   }
 }
 
+// follow the cursor through the shadow of DDRAM
+void Adafruit_LiquidCrystal::track(uint8_t value, boolean mode) {
+  if (mode == LOW) {
+    if (value >= LCD_SETDDRAMADDR)
+      _col = LCD_POS_UNKNOWN;
+    else if (value >= LCD_SETCGRAMADDR)
+      _col = LCD_POS_CGRAM;
+    else if ((value & 0xF0) == LCD_CURSORSHIFT && !(value & LCD_DISPLAYMOVE))
+      _col = LCD_POS_UNKNOWN;
+    return;
+  }
+  if (!_shadow || _col == LCD_POS_CGRAM)
+    return;
+  if (_col < _numcols &&
+      (_displaymode & (LCD_ENTRYLEFT | LCD_ENTRYSHIFTINCREMENT)) == LCD_ENTRYLEFT) {
+    _shadow[_row * _numcols + _col++] = value;
+  } else {
+    // cannot tell which cell was written
+    memset(_shadow, 0, _numcols * _numlines);
+    _col = LCD_POS_UNKNOWN;
+  }
+}
+
+void Adafruit_LiquidCrystal::_i2cPush(uint8_t out) {
+  if (_i2cfill == sizeof(_i2cbuff))
+    _i2cFlush();
+  _i2cbuff[_i2cfill++] = out;
+}
+
+void Adafruit_LiquidCrystal::_i2cFlush() {
+  if (_i2cAddr == 255) return;
+  if (_i2cfill) {
+    _i2c.writeGPIO(_i2cbuff, _i2cfill);
+    _i2cfill = 0;
+  }
+}
+
+// expander outputs as they will be after the queued states are written
+uint8_t Adafruit_LiquidCrystal::_i2cOutput() {
+  return _i2cfill ? _i2cbuff[_i2cfill - 1] : _i2c.latchGPIO();
+}
+
 void Adafruit_LiquidCrystal::pulseEnable(void) {
   _digitalWrite(_enable_pin, LOW);
   delayMicroseconds(1);    
@@ -410,10 +525,7 @@ void Adafruit_LiquidCrystal::pulseEnable(void) {
 
 void Adafruit_LiquidCrystal::write4bits(uint8_t value) {
   if (_i2cAddr != 255) {
-    uint8_t out = 0;
-
-    out = _i2c.readGPIO();
-
+    uint8_t out = _i2cOutput();
 
     // speed up for i2c since its sluggish
     for (int i = 0; i < 4; i++) {
@@ -421,19 +533,10 @@ void Adafruit_LiquidCrystal::write4bits(uint8_t value) {
       out |= ((value >> i) & 0x1) << _data_pins[i];
     }
 
-    // make sure enable is low
-    out &= ~ _BV(_enable_pin);
-
-    _i2c.writeGPIO(out);
-
-    // pulse enable
-    delayMicroseconds(1);
-    out |= _BV(_enable_pin);
-    _i2c.writeGPIO(out);
-    delayMicroseconds(1);
-    out &= ~_BV(_enable_pin);
-    _i2c.writeGPIO(out);   
-    delayMicroseconds(100);
+    // data is latched on the falling edge of enable, so it may change
+    // together with the rising one; a byte time is far above 450ns
+    _i2cPush(out | _BV(_enable_pin));
+    _i2cPush(out & ~_BV(_enable_pin));
   } else {
     for (int i = 0; i < 4; i++) {
       _pinMode(_data_pins[i], OUTPUT);
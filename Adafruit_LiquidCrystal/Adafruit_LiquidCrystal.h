@@ -87,14 +87,22 @@ public:
 
   void createChar(uint8_t, uint8_t[]);
   void setCursor(uint8_t, uint8_t); 
+  // rewrite a whole row, touching only cells that differ from what is shown
+  void printLine(uint8_t row, const char *text);
 #if ARDUINO >= 100
   virtual size_t write(uint8_t);
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  using Print::write;
 #else
   virtual void write(uint8_t);
 #endif
   void command(uint8_t);
 private:
   void send(uint8_t value, boolean mode);
+  void track(uint8_t value, boolean mode);
+  void _i2cPush(uint8_t);
+  void _i2cFlush();
+  uint8_t _i2cOutput();
   void write4bits(uint8_t);
   void write8bits(uint8_t);
   void pulseEnable();
@@ -113,12 +121,19 @@ private:
   uint8_t _initialized;
 
   uint8_t _numlines,_currline;
+  uint8_t _numcols;
+
+  // characters in DDRAM as last written (0 is unknown), and cursor position
+  uint8_t *_shadow;
+  uint8_t _col, _row;
 
   uint8_t _SPIclock, _SPIdata, _SPIlatch;
   uint8_t _SPIbuff;
 
   uint8_t _i2cAddr;
   Adafruit_MCP23008 _i2c;
+  uint8_t _i2cbuff[MCP23008_GPIO_BATCH]; // pending expander output states
+  uint8_t _i2cfill;
 };
 
 #endif
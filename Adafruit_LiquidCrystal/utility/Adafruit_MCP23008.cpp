@@ -31,6 +31,10 @@ void Adafruit_MCP23008::begin(uint8_t addr) {
   Wire.begin();
   Wire.setSpeed(FAST);
 
+  // IOCON survives an MCU-only reset, clear SEQOP so the burst below
+  // steps through the registers instead of landing on IODIR
+  write8(MCP23008_IOCON, 0);
+
   // set defaults!
   Wire.beginTransmission(MCP23008_ADDRESS | i2caddr);
 #if ARDUINO >= 100
@@ -60,6 +64,9 @@ void Adafruit_MCP23008::begin(uint8_t addr) {
 #endif
   Wire.endTransmission();
 
+  // byte mode, so that a run of writes to GPIO stays on GPIO
+  write8(MCP23008_IOCON, MCP23008_SEQOP);
+  olat = 0;
 }
 
 void Adafruit_MCP23008::begin(void) {
@@ -94,6 +101,28 @@ uint8_t Adafruit_MCP23008::readGPIO(void) {
 
 void Adafruit_MCP23008::writeGPIO(uint8_t gpio) {
   write8(MCP23008_GPIO, gpio);
+  olat = gpio;
+}
+
+// write a sequence of output states, one I2C transaction per MCP23008_GPIO_BATCH values
+void Adafruit_MCP23008::writeGPIO(const uint8_t *data, uint8_t n) {
+  while (n > 0) {
+    uint8_t len = n < MCP23008_GPIO_BATCH ? n : MCP23008_GPIO_BATCH;
+    Wire.beginTransmission(MCP23008_ADDRESS | i2caddr);
+#if ARDUINO >= 100
+    Wire.write((byte)MCP23008_GPIO);
+    for (uint8_t i = 0; i < len; i++)
+      Wire.write((byte)data[i]);
+#else
+    Wire.send(MCP23008_GPIO);
+    for (uint8_t i = 0; i < len; i++)
+      Wire.send(data[i]);
+#endif
+    Wire.endTransmission();
+    olat = data[len - 1];
+    data += len;
+    n -= len;
+  }
 }
 
 
@@ -104,8 +133,8 @@ void Adafruit_MCP23008::digitalWrite(uint8_t p, uint8_t d) {
   if (p > 7)
     return;
 
-  // read the current GPIO output latches
-  gpio = readGPIO();
+  // the output latches are shadowed, no need to read them back
+  gpio = olat;
 
   // set the pin and direction
   if (d == HIGH) {
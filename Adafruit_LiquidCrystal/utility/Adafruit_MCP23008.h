@@ -25,9 +25,12 @@ public:
   uint8_t digitalRead(uint8_t p);
   uint8_t readGPIO(void);
   void writeGPIO(uint8_t);
+  void writeGPIO(const uint8_t *data, uint8_t n);
+  uint8_t latchGPIO(void) { return olat; }  // last value written, no I2C
 
  private:
   uint8_t i2caddr;
+  uint8_t olat;
   uint8_t read8(uint8_t addr);
   void write8(uint8_t addr, uint8_t data);
 };
@@ -47,4 +50,10 @@ public:
 #define MCP23008_GPIO 0x09
 #define MCP23008_OLAT 0x0A
 
+// IOCON bits
+#define MCP23008_SEQOP 0x20 // address pointer does not increment
+
+// GPIO values per writeGPIO(data, n) transaction: Wire buffer less the register byte
+#define MCP23008_GPIO_BATCH 31
+
 #endif
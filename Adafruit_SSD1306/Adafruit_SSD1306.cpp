@@ -171,7 +171,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi,
                                    int8_t rst_pin, uint32_t clkDuring,
                                    uint32_t clkAfter)
     : Adafruit_GFX(w, h), spi(NULL), wire(twi ? twi : &Wire), buffer(NULL),
-      mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1), rstPin(rst_pin)
+      dirty(NULL), mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1),
+      rstPin(rst_pin)
 #if ARDUINO >= 157
       ,
       wireClk(clkDuring), restoreClk(clkAfter)
@@ -209,7 +210,7 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi,
 Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, int8_t mosi_pin,
                                    int8_t sclk_pin, int8_t dc_pin,
                                    int8_t rst_pin, int8_t cs_pin)
-    : Adafruit_GFX(w, h), spi(NULL), wire(NULL), buffer(NULL),
+    : Adafruit_GFX(w, h), spi(NULL), wire(NULL), buffer(NULL), dirty(NULL),
       mosiPin(mosi_pin), clkPin(sclk_pin), dcPin(dc_pin), csPin(cs_pin),
       rstPin(rst_pin) {}
 
@@ -243,7 +244,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, SPIClass *spi,
                                    int8_t dc_pin, int8_t rst_pin, int8_t cs_pin,
                                    uint32_t bitrate)
     : Adafruit_GFX(w, h), spi(spi ? spi : &SPI), wire(NULL), buffer(NULL),
-      mosiPin(-1), clkPin(-1), dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {
+      dirty(NULL), mosiPin(-1), clkPin(-1), dcPin(dc_pin), csPin(cs_pin),
+      rstPin(rst_pin) {
 #ifdef SPI_HAS_TRANSACTION
   spiSettings = SPISettings(bitrate, MSBFIRST, SPI_MODE0);
 #endif
@@ -278,8 +280,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, SPIClass *spi,
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t mosi_pin, int8_t sclk_pin,
                                    int8_t dc_pin, int8_t rst_pin, int8_t cs_pin)
     : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), spi(NULL), wire(NULL),
-      buffer(NULL), mosiPin(mosi_pin), clkPin(sclk_pin), dcPin(dc_pin),
-      csPin(cs_pin), rstPin(rst_pin) {}
+      buffer(NULL), dirty(NULL), mosiPin(mosi_pin), clkPin(sclk_pin),
+      dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {}
 
 /*!
     @brief  DEPRECATED constructor for SPI SSD1306 displays, using native
@@ -304,8 +306,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(int8_t mosi_pin, int8_t sclk_pin,
 */
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t dc_pin, int8_t rst_pin, int8_t cs_pin)
     : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), spi(&SPI), wire(NULL),
-      buffer(NULL), mosiPin(-1), clkPin(-1), dcPin(dc_pin), csPin(cs_pin),
-      rstPin(rst_pin) {
+      buffer(NULL), dirty(NULL), mosiPin(-1), clkPin(-1), dcPin(dc_pin),
+      csPin(cs_pin), rstPin(rst_pin) {
 #ifdef SPI_HAS_TRANSACTION
   spiSettings = SPISettings(8000000, MSBFIRST, SPI_MODE0);
 #endif
@@ -327,7 +329,7 @@ Adafruit_SSD1306::Adafruit_SSD1306(int8_t dc_pin, int8_t rst_pin, int8_t cs_pin)
 */
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t rst_pin)
     : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), spi(NULL), wire(&Wire),
-      buffer(NULL), mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1),
+      buffer(NULL), dirty(NULL), mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1),
       rstPin(rst_pin) {}
 
 /*!
@@ -337,6 +339,7 @@ Adafruit_SSD1306::~Adafruit_SSD1306(void) {
   if (buffer) {
     free(buffer);
     buffer = NULL;
+    dirty = NULL;
   }
 }
 
@@ -406,6 +409,36 @@ void Adafruit_SSD1306::ssd1306_commandList(const uint8_t *c, uint8_t n) {
   }
 }
 
+// Set the GDDRAM window that following data bytes are written into.
+// The six command bytes go out in a single I2C transmission. Same rules
+// as above re: transactions. This is a private function, not exposed.
+void Adafruit_SSD1306::ssd1306_window(uint8_t page0, uint8_t page1,
+                                      uint8_t col0, uint8_t col1) {
+  uint8_t cmd[6] = {SSD1306_PAGEADDR,   page0, page1,
+                    SSD1306_COLUMNADDR, col0,  col1};
+  if (wire) { // I2C
+    wire->beginTransmission(i2caddr);
+    WIRE_WRITE((uint8_t)0x00); // Co = 0, D/C = 0
+    for (uint8_t i = 0; i < sizeof(cmd); i++)
+      WIRE_WRITE(cmd[i]);
+    wire->endTransmission();
+  } else { // SPI -- transaction started in calling function
+    SSD1306_MODE_COMMAND
+    for (uint8_t i = 0; i < sizeof(cmd); i++)
+      SPIwrite(cmd[i]);
+  }
+}
+
+// Widen the dirty column range of one page to include columns x0..x1.
+// Clean pages hold {0xFF, 0}, so any mark replaces both ends.
+inline void Adafruit_SSD1306::markDirty(uint8_t page, uint8_t x0, uint8_t x1) {
+  uint8_t *d = &dirty[page * 2];
+  if (x0 < d[0])
+    d[0] = x0;
+  if (x1 > d[1])
+    d[1] = x1;
+}
+
 // A public version of ssd1306_command1(), for existing user code that
 // might rely on that function. This encapsulates the command transfer
 // in a transaction start/end, similar to old library's handling of it.
@@ -462,8 +495,12 @@ void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
 bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, bool reset,
                              bool periphBegin) {
 
-  if ((!buffer) && !(buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8))))
+  // Dirty column ranges (two bytes per page) share one allocation with
+  // the image buffer.
+  if ((!buffer) && !(buffer = (uint8_t *)malloc((WIDTH + 2) *
+                                                  ((HEIGHT + 7) / 8))))
     return false;
+  dirty = buffer + WIDTH * ((HEIGHT + 7) / 8);
 
   clearDisplay();
   if (HEIGHT > 32) {
@@ -632,6 +669,7 @@ void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
       buffer[x + (y / 8) * WIDTH] ^= (1 << (y & 7));
       break;
     }
+    markDirty(y / 8, x, x);
   }
 }
 
@@ -644,6 +682,22 @@ void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
 */
 void Adafruit_SSD1306::clearDisplay(void) {
   memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+  markDirty();
+}
+
+/*!
+    @brief  Mark the whole display buffer as changed, so that the next
+            display() call pushes all of it.
+    @return None (void).
+    @note   display() sends only the regions touched by drawing functions
+            since the previous call. Use this after writing directly into
+            the array returned by getBuffer().
+*/
+void Adafruit_SSD1306::markDirty(void) {
+  for (uint8_t page = 0; page < (HEIGHT + 7) / 8; page++) {
+    dirty[page * 2] = 0;
+    dirty[page * 2 + 1] = WIDTH - 1;
+  }
 }
 
 /*!
@@ -706,6 +760,7 @@ void Adafruit_SSD1306::drawFastHLineInternal(int16_t x, int16_t y, int16_t w,
       w = (WIDTH - x);
     }
     if (w > 0) { // Proceed only if width is positive
+      markDirty(y / 8, x, x + w - 1);
       uint8_t *pBuf = &buffer[(y / 8) * WIDTH + x], mask = 1 << (y & 7);
       switch (color) {
       case SSD1306_WHITE:
@@ -793,6 +848,8 @@ void Adafruit_SSD1306::drawFastVLineInternal(int16_t x, int16_t __y,
       // use local byte registers for faster juggling
       uint8_t y = __y, h = __h;
       uint8_t *pBuf = &buffer[(y / 8) * WIDTH + x];
+      for (uint8_t page = y / 8; page <= (y + h - 1) / 8; page++)
+        markDirty(page, x, x);
 
       // do the first partial byte, if necessary - this requires some masking
       uint8_t mod = (y & 7);
@@ -910,6 +967,8 @@ bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
     @brief  Get base address of display buffer for direct reading or writing.
     @return Pointer to an unsigned 8-bit array, column-major, columns padded
             to full byte boundary if needed.
+    @note   Call markDirty() after writing into the array directly, or the
+            change may not be sent by the next display().
 */
 uint8_t *Adafruit_SSD1306::getBuffer(void) { return buffer; }
 
@@ -921,17 +980,11 @@ uint8_t *Adafruit_SSD1306::getBuffer(void) { return buffer; }
     @note   Drawing operations are not visible until this function is
             called. Call after each graphics command, or after a whole set
             of graphics commands, as best needed by one's own application.
+            Only the page/column windows changed since the previous call
+            are sent; see markDirty() for direct buffer writes.
 */
 void Adafruit_SSD1306::display(void) {
   TRANSACTION_START
-  static const uint8_t PROGMEM dlist1[] = {
-      SSD1306_PAGEADDR,
-      0,                      // Page start address
-      0xFF,                   // Page end (not really, but works here)
-      SSD1306_COLUMNADDR, 0}; // Column start address
-  ssd1306_commandList(dlist1, sizeof(dlist1));
-  ssd1306_command1(WIDTH - 1); // Column end address
-
 #if defined(ESP8266)
   // ESP8266 needs a periodic yield() call to avoid watchdog reset.
   // With the limited size of SSD1306 displays, and the fast bitrate
@@ -941,27 +994,54 @@ void Adafruit_SSD1306::display(void) {
   // 32-byte transfer condition below.
   yield();
 #endif
-  uint16_t count = WIDTH * ((HEIGHT + 7) / 8);
-  uint8_t *ptr = buffer;
-  if (wire) { // I2C
-    wire->beginTransmission(i2caddr);
-    WIRE_WRITE((uint8_t)0x40);
-    uint8_t bytesOut = 1;
-    while (count--) {
-      if (bytesOut >= WIRE_MAX) {
-        wire->endTransmission();
-        wire->beginTransmission(i2caddr);
-        WIRE_WRITE((uint8_t)0x40);
-        bytesOut = 1;
+  uint8_t pages = (HEIGHT + 7) / 8;
+  uint8_t page = 0;
+  while (page < pages) {
+    uint8_t col0 = dirty[page * 2], col1 = dirty[page * 2 + 1];
+    if (col0 > col1) { // Clean page
+      page++;
+      continue;
+    }
+    // Consecutive pages with the same dirty columns share one window
+    // (a cleared or fully redrawn screen goes out as a single window).
+    uint8_t page1 = page;
+    while ((page1 + 1 < pages) && (dirty[(page1 + 1) * 2] == col0) &&
+           (dirty[(page1 + 1) * 2 + 1] == col1))
+      page1++;
+    ssd1306_window(page, page1, col0, col1);
+    uint8_t width = col1 - col0 + 1;
+    if (wire) { // I2C
+      wire->beginTransmission(i2caddr);
+      WIRE_WRITE((uint8_t)0x40);
+      uint8_t bytesOut = 1;
+      for (; page <= page1; page++) {
+        uint8_t *ptr = &buffer[page * WIDTH + col0];
+        uint8_t count = width;
+        while (count--) {
+          if (bytesOut >= WIRE_MAX) {
+            wire->endTransmission();
+            wire->beginTransmission(i2caddr);
+            WIRE_WRITE((uint8_t)0x40);
+            bytesOut = 1;
+          }
+          WIRE_WRITE(*ptr++);
+          bytesOut++;
+        }
+        dirty[page * 2] = 0xFF;
+        dirty[page * 2 + 1] = 0;
+      }
+      wire->endTransmission();
+    } else { // SPI
+      SSD1306_MODE_DATA
+      for (; page <= page1; page++) {
+        uint8_t *ptr = &buffer[page * WIDTH + col0];
+        uint8_t count = width;
+        while (count--)
+          SPIwrite(*ptr++);
+        dirty[page * 2] = 0xFF;
+        dirty[page * 2 + 1] = 0;
       }
-      WIRE_WRITE(*ptr++);
-      bytesOut++;
     }
-    wire->endTransmission();
-  } else { // SPI
-    SSD1306_MODE_DATA
-    while (count--)
-      SPIwrite(*ptr++);
   }
   TRANSACTION_END
 #if defined(ESP8266)
@@ -159,6 +159,7 @@ public:
   void ssd1306_command(uint8_t c);
   bool getPixel(int16_t x, int16_t y);
   uint8_t *getBuffer(void);
+  void markDirty(void);
 
 private:
   inline void SPIwrite(uint8_t d) __attribute__((always_inline));
@@ -166,10 +167,15 @@ private:
   void drawFastVLineInternal(int16_t x, int16_t y, int16_t h, uint16_t color);
   void ssd1306_command1(uint8_t c);
   void ssd1306_commandList(const uint8_t *c, uint8_t n);
+  void ssd1306_window(uint8_t page0, uint8_t page1, uint8_t col0,
+                      uint8_t col1);
+  inline void markDirty(uint8_t page, uint8_t x0, uint8_t x1)
+      __attribute__((always_inline));
 
   SPIClass *spi;
   TwoWire *wire;
   uint8_t *buffer;
+  uint8_t *dirty; // Per-page dirty column range {first, last}, after buffer
   int8_t i2caddr, vccstate, page_end;
   int8_t mosiPin, clkPin, dcPin, csPin, rstPin;
 #ifdef HAVE_PORTREG
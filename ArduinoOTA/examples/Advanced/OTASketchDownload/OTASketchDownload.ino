@@ -92,6 +92,10 @@ void handleSketchDownload() {
     Serial.println(" bytes. Can't continue with update.");
     return;
   }
+  if (!InternalStorage.verify()) {
+    Serial.println("Stored update file is corrupt. Can't continue with update.");
+    return;
+  }
 
   Serial.println("Sketch update apply and reset.");
   Serial.flush();
@@ -27,12 +27,38 @@
 
 #include "InternalStorage.h"
 
+#if defined(ARDUINO_ARCH_SAMD)
+// SAMD erases rows of four pages
+#define ERASE_SIZE (PAGE_SIZE * 4)
+#else
+#define ERASE_SIZE PAGE_SIZE
+#endif
+
+// CRC32 as in zlib, a nibble at a time to keep the table small
+static const uint32_t crcTable[16] = {
+  0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+  0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+static uint32_t updateCrc(uint32_t crc, const uint8_t* data, size_t size)
+{
+  for (size_t i = 0; i < size; i++) {
+    crc = crcTable[(crc ^ data[i]) & 0x0f] ^ (crc >> 4);
+    crc = crcTable[(crc ^ (data[i] >> 4)) & 0x0f] ^ (crc >> 4);
+  }
+  return crc;
+}
+
 InternalStorageClass::InternalStorageClass() :
   MAX_PARTIONED_SKETCH_SIZE((MAX_FLASH - SKETCH_START_ADDRESS) / 2),
   STORAGE_START_ADDRESS(SKETCH_START_ADDRESS + MAX_PARTIONED_SKETCH_SIZE)
 {
   _writeIndex = 0;
   _writeAddress = nullptr;
+  _eraseAddress = STORAGE_START_ADDRESS;
+  _received = 0;
+  _crc = 0xffffffff;
+  _overflow = false;
 }
 
 void InternalStorageClass::debugPrint() {
@@ -114,18 +140,44 @@ int InternalStorageClass::open(int length)
   (void)length;
   _writeIndex = 0;
   _writeAddress = (uint32_t*)STORAGE_START_ADDRESS;
+  _eraseAddress = STORAGE_START_ADDRESS;
+  _received = 0;
+  _crc = 0xffffffff;
+  _overflow = false;
 
 #ifdef ARDUINO_ARCH_SAMD
   // enable auto page writes
   NVMCTRL->CTRLB.bit.MANW = 0;
 #endif
 
-  eraseFlash(STORAGE_START_ADDRESS, MAX_PARTIONED_SKETCH_SIZE, PAGE_SIZE);
-
+  // pages are erased in prepare() as the writes reach them
   return 1;
 }
 
-size_t InternalStorageClass::write(uint8_t b)
+// erases the next row or page when the write address reaches it,
+// returns false if not open or at the end of the storage
+bool InternalStorageClass::prepare()
+{
+  if (_writeAddress == nullptr) {
+    return false;
+  }
+
+  uint32_t address = (uint32_t)_writeAddress;
+
+  if (address >= STORAGE_START_ADDRESS + MAX_PARTIONED_SKETCH_SIZE) {
+    _overflow = true;
+    return false;
+  }
+
+  if (address >= _eraseAddress) {
+    eraseFlash(_eraseAddress, ERASE_SIZE, PAGE_SIZE);
+    _eraseAddress += ERASE_SIZE;
+  }
+
+  return true;
+}
+
+void InternalStorageClass::put(uint8_t b)
 {
   _addressData.u8[_writeIndex] = b;
   _writeIndex++;
@@ -133,33 +185,100 @@ size_t InternalStorageClass::write(uint8_t b)
   if (_writeIndex == 4) {
     _writeIndex = 0;
 
+    if (!prepare()) {
+      return;
+    }
+
     *_writeAddress = _addressData.u32;
 
     _writeAddress++;
 
     waitForReady();
   }
+}
+
+size_t InternalStorageClass::write(uint8_t b)
+{
+  _crc = updateCrc(_crc, &b, 1);
+  _received++;
+
+  put(b);
 
   return 1;
 }
 
+size_t InternalStorageClass::write(const uint8_t* buffer, size_t size)
+{
+  size_t i = 0;
+
+  _crc = updateCrc(_crc, buffer, size);
+  _received += size;
+
+  // complete a partially assembled word
+  while (i < size && _writeIndex != 0) {
+    put(buffer[i++]);
+  }
+
+  while (size - i >= 4) {
+    if (!prepare()) {
+      return i;
+    }
+
+    memcpy(_addressData.u8, &buffer[i], 4);
+    *_writeAddress = _addressData.u32;
+    _writeAddress++;
+    i += 4;
+
+#ifdef ARDUINO_ARCH_SAMD
+    // words only fill the page buffer, writing the last one of a page
+    // starts the automatic page write
+    if (((uint32_t)_writeAddress % PAGE_SIZE) == 0)
+#endif
+      waitForReady();
+  }
+
+  while (i < size) {
+    put(buffer[i++]);
+  }
+
+  return size;
+}
+
 void InternalStorageClass::close()
 {
-  while ((int)_writeAddress % PAGE_SIZE) {
-    write(0xff);
+  // padding is not part of the received image and its CRC
+  while (!_overflow && (_writeIndex != 0 || (int)_writeAddress % PAGE_SIZE)) {
+    put(0xff);
   }
 }
 
+bool InternalStorageClass::verify()
+{
+  if (_writeAddress == nullptr || _overflow || _writeIndex != 0) {
+    return false;
+  }
+
+  // read back the stored image, so a failed flash write is caught, too
+  return updateCrc(0xffffffff, (const uint8_t*)STORAGE_START_ADDRESS, _received) == _crc;
+}
+
 void InternalStorageClass::clear()
 {
+  _writeAddress = nullptr;
 }
 
 void InternalStorageClass::apply()
 {
+  // keep running the current sketch if the stored one is not complete
+  if (!verify()) {
+    return;
+  }
+
   // disable interrupts, as vector table will be erase during flash sequence
   noInterrupts();
 
-  copyFlashAndReset(SKETCH_START_ADDRESS, STORAGE_START_ADDRESS, MAX_PARTIONED_SKETCH_SIZE, PAGE_SIZE);
+  // only the pages written since open(), close() padded the last one
+  copyFlashAndReset(SKETCH_START_ADDRESS, STORAGE_START_ADDRESS, (uint32_t)_writeAddress - STORAGE_START_ADDRESS, PAGE_SIZE);
 }
 
 long InternalStorageClass::maxSize()
@@ -33,11 +33,18 @@ public:
 
   virtual int open(int length);
   virtual size_t write(uint8_t);
+  virtual size_t write(const uint8_t* buffer, size_t size);
   virtual void close();
+  virtual bool verify();
   virtual void clear();
   virtual void apply();
   virtual long maxSize();
 
+  // CRC32 of the bytes written since open()
+  uint32_t crc32() {
+    return ~_crc;
+  }
+
   void debugPrint();
 
 private:
@@ -50,6 +57,13 @@ private:
 
   int _writeIndex;
   uint32_t* _writeAddress;
+  uint32_t _eraseAddress; // first address not erased since open()
+  uint32_t _received;
+  uint32_t _crc;
+  bool _overflow;
+
+  void put(uint8_t b);
+  bool prepare();
 };
 
 extern InternalStorageClass InternalStorage;
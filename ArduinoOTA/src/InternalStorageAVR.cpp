@@ -54,6 +54,32 @@ size_t InternalStorageAVRClass::write(uint8_t b) {
   return 1;
 }
 
+size_t InternalStorageAVRClass::write(const uint8_t* buffer, size_t size) {
+  size_t i = 0;
+  while (i < size) {
+    if ((pageIndex % 2) || (size - i) < 2) {
+      // odd byte of a word, or the last byte of the buffer
+      InternalStorageAVRClass::write(buffer[i++]);
+      continue;
+    }
+    if (pageIndex == 0) {
+      optiboot_page_erase(pageAddress);
+    }
+    // fill the page buffer a word at a time
+    while (pageIndex < SPM_PAGESIZE && (size - i) >= 2) {
+      optiboot_page_fill(pageAddress + pageIndex, buffer[i] | (buffer[i + 1] << 8));
+      pageIndex += 2;
+      i += 2;
+    }
+    if (pageIndex == SPM_PAGESIZE) {
+      optiboot_page_write(pageAddress);
+      pageIndex = 0;
+      pageAddress += SPM_PAGESIZE;
+    }
+  }
+  return size;
+}
+
 void InternalStorageAVRClass::close() {
   if (pageIndex) {
     optiboot_page_write(pageAddress);
@@ -31,6 +31,7 @@ public:
   }
   virtual int open(int length, uint8_t command);
   virtual size_t write(uint8_t);
+  virtual size_t write(const uint8_t* buffer, size_t size);
   virtual void close();
   virtual void clear();
   virtual void apply();
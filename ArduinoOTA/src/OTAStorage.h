@@ -26,6 +26,16 @@
 
 #include <Arduino.h>
 
+// Size of the chunks in which WiFiOTA receives an upload and hands it to
+// OTAStorage::write(const uint8_t*, size_t)
+#ifndef OTA_BUFFER_SIZE
+#ifdef __AVR__
+#define OTA_BUFFER_SIZE SPM_PAGESIZE
+#else
+#define OTA_BUFFER_SIZE 256
+#endif
+#endif
+
 class OTAStorage {
 public:
 
@@ -37,7 +47,17 @@ public:
     return open(length);
   }
   virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      write(buffer[i]);
+    }
+    return size;
+  }
   virtual void close() = 0;
+  // checks the stored update after close(), before it is applied
+  virtual bool verify() {
+    return true;
+  }
   virtual void clear() = 0;
   virtual void apply() = 0;
 
@@ -40,6 +40,11 @@ public:
   virtual size_t write(uint8_t b) {
     return _file.write(b);
   }
+
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    return _file.write(buffer, size);
+  }
+
   virtual void close() {
     _file.close();
   }
@@ -57,6 +57,11 @@ public:
     return ret;
   }
 
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    while (!SerialFlash.ready()) {}
+    return _file.write(buffer, size);
+  }
+
   virtual void close() {
     _file.close();
   }
@@ -63,6 +63,26 @@ static String base64Encode(const String& in)
   return out;
 }
 
+// Reads one line of the request head into buffer, without heap allocation,
+// and returns it trimmed like String::trim() does.
+static char* readLine(Client& client, char* buffer, size_t size)
+{
+  size_t length = client.readBytesUntil('\n', buffer, size - 1);
+  if (length == size - 1) {
+    // drop the rest of an overlong line
+    char rest[16];
+    while (client.readBytesUntil('\n', rest, sizeof(rest)) == sizeof(rest));
+  }
+  while (length > 0 && isspace(buffer[length - 1])) {
+    length--;
+  }
+  buffer[length] = 0;
+  while (isspace(*buffer)) {
+    buffer++;
+  }
+  return buffer;
+}
+
 WiFiOTAClass::WiFiOTAClass() :
   _storage(NULL),
   localIp(0),
@@ -230,41 +250,45 @@ void WiFiOTAClass::pollServer(Client& client)
 {
 
   if (client) {
-    String request = client.readStringUntil('\n');
-    request.trim();
+    // the Authorization header grows with the password, make room for it
+    size_t lineSize = 20 + _expectedAuthorization.length();
+    if (lineSize < OTA_LINE_SIZE) {
+      lineSize = OTA_LINE_SIZE;
+    }
+    char line[lineSize];
+    char* request = readLine(client, line, sizeof(line));
+
+    // the line buffer is reused for the headers, so check the request first
+    bool dataUpload = false;
+    bool validRequest = (strcmp(request, "POST /sketch HTTP/1.1") == 0);
+#if defined(ESP8266) || defined(ESP32)
+    if (strcmp(request, "POST /data HTTP/1.1") == 0) {
+      dataUpload = true;
+      validRequest = true;
+    }
+#endif
 
-    String header;
+    char* header;
     long contentLength = -1;
-    String authorization;
+    bool authorized = false;
 
     do {
-      header = client.readStringUntil('\n');
-      header.trim();
+      header = readLine(client, line, sizeof(line));
 
-      if (header.startsWith("Content-Length: ")) {
-        header.remove(0, 16);
-
-        contentLength = header.toInt();
-      } else if (header.startsWith("Authorization: ")) {
-        header.remove(0, 15);
-
-        authorization = header;
+      if (strncmp(header, "Content-Length: ", 16) == 0) {
+        contentLength = atol(header + 16);
+      } else if (strncmp(header, "Authorization: ", 15) == 0) {
+        authorized = (strcmp(header + 15, _expectedAuthorization.c_str()) == 0);
       }
-    } while (header != "");
+    } while (*header);
 
-    bool dataUpload = false;
-#if defined(ESP8266) || defined(ESP32)
-    if (request == "POST /data HTTP/1.1") {
-      dataUpload = true;
-    } else
-#endif
-    if (request != "POST /sketch HTTP/1.1") {
+    if (!validRequest) {
       flushRequestBody(client, contentLength);
       sendHttpResponse(client, 404, "Not Found");
       return;
     }
 
-    if (_expectedAuthorization != authorization) {
+    if (!authorized) {
       flushRequestBody(client, contentLength);
       sendHttpResponse(client, 401, "Unauthorized");
       return;
@@ -289,21 +313,30 @@ void WiFiOTAClass::pollServer(Client& client)
     }
 
     long read = 0;
-    byte buff[64];
+    byte buff[OTA_BUFFER_SIZE];
 
     while (client.connected() && read < contentLength) {
       while (client.available()) {
         int l = client.read(buff, sizeof(buff));
-        for (int i = 0; i < l; i++) {
-          _storage->write(buff[i]);
+        if (l <= 0) {
+          break;
         }
+        _storage->write(buff, l);
         read += l;
       }
     }
 
     _storage->close();
 
-    if (read == contentLength) {
+    if (read == contentLength && !_storage->verify()) {
+      // stored update differs from the received one
+      sendHttpResponse(client, 500, "Internal Server Error");
+      _storage->clear();
+
+      delay(500);
+
+      client.stop();
+    } else if (read == contentLength) {
       sendHttpResponse(client, 200, "OK");
 
       delay(500);
@@ -32,6 +32,14 @@
 
 #include "OTAStorage.h"
 
+// Longest request line or header kept by pollServer(), including the
+// terminating zero. Longer lines are cut, which fails their comparison.
+// The buffer is made larger when the Authorization header of a long
+// password needs it.
+#ifndef OTA_LINE_SIZE
+#define OTA_LINE_SIZE 128
+#endif
+
 class WiFiOTAClass {
 protected:
   WiFiOTAClass();
@@ -12,22 +12,14 @@ DS18B20::DS18B20(uint8_t pin) :
   _wire(pin),
   _timeout(TEMP_INTERVAL)
 {
-  clear();
   startConversion();
 }
 
-void DS18B20::clear() {
-  for (uint8_t i = 0; i < QUEUE_SIZE; i++)
-    _queue[i] = NO_VAL;
-  _size = 0;
-  _value.clear();
-}
-
 bool DS18B20::fail() {
   if (_fail_count >= FAIL_LIMIT) {
-    if (_size == 0)
+    if (_filter.count() == 0)
       return false; // already cleared
-    clear();
+    _filter.clear();
     return true;
   } else {
     _fail_count++;
@@ -45,14 +37,7 @@ bool DS18B20::check() {
     result = fail();
   } else {
     _fail_count = 0;
-    // enqueue new value
-    _queue[_index++] = val;
-    if (_index == QUEUE_SIZE)
-      _index = 0;
-    if (_size < QUEUE_SIZE)
-      _size++;
-    // reset computed value
-    _value.clear();
+    _filter.addRaw(val);
     // reset error
     _last_error = 0;
     result = true;
@@ -62,9 +47,7 @@ bool DS18B20::check() {
 }
 
 DS18B20::temp_t DS18B20::getTemp() {
-  if (!_value && _size > 0)
-    computeValue();
-  return _value;
+  return _filter.getValue();
 }
 
 uint8_t DS18B20::getLastError() {
@@ -77,12 +60,16 @@ int16_t DS18B20::readScratchPad() {
     return NO_VAL;
   }
   _wire.skip();
-  _wire.write(0xBE); // Read Scratchpad
+  return readScratchPad(_wire, _last_error);
+}
+
+int16_t DS18B20::readScratchPad(OneWire& wire, uint8_t& error) {
+  wire.write(0xBE); // Read Scratchpad
   byte data[DS18B20_SPS];
   for (uint8_t i = 0; i < DS18B20_SPS; i++) // we need it with CRC
-    data[i] = _wire.read();
+    data[i] = wire.read();
   if (OneWire::crc8(&data[0], DS18B20_SPS - 1) != data[DS18B20_SPS - 1]) {
-    _last_error = 2;
+    error = 2;
     return NO_VAL;
   }
   return (data[1] << 8) + data[0]; // take the two bytes from the response relating to temperature
@@ -98,24 +85,118 @@ bool DS18B20::startConversion() {
   return false;
 }
 
-void DS18B20::computeValue() {
-  int hi = INT_MIN;
-  int lo = INT_MAX;
-  int sum = 0;
-  int count = 0;
-  for (uint8_t i = 0; i < QUEUE_SIZE; i++)
-    if (_queue[i] != NO_VAL) {
-      sum += _queue[i];
-      hi = max(hi, _queue[i]);
-      lo = min(lo, _queue[i]);
-      count++;
-    }
-  if (count > 2) {
-    // drop outliers for even higher precision
-    sum -= hi;
-    sum -= lo;
-    count -= 2;
+// ------------ DS18B20Bus ------------
+
+// Family code of DS18B20 in the first ROM byte
+const uint8_t DS18B20_FAMILY = 0x28;
+
+DS18B20Bus::DS18B20Bus(uint8_t pin, Sensor* sensors, uint8_t capacity) :
+  _wire(pin),
+  _sensors(sensors),
+  _capacity(capacity),
+  _count(0),
+  _next(0),
+  _changed(false),
+  _failed(false),
+  _last_error(0)
+{}
+
+uint8_t DS18B20Bus::begin() {
+  _count = 0;
+  _wire.reset_search();
+  while (_count < _capacity) {
+    Sensor& s = _sensors[_count];
+    if (!_wire.search(s.rom))
+      break;
+    if (OneWire::crc8(s.rom, 7) != s.rom[7] || s.rom[0] != DS18B20_FAMILY)
+      continue; // garbled search or some other device on the bus
+    s.fail_count = 0;
+    s.filter.clear();
+    _count++;
+  }
+  _next = _count;
+  if (_count == 0) {
+    _last_error = 4;
+    return 0;
+  }
+  startConversion();
+  return _count;
+}
+
+bool DS18B20Bus::fail(Sensor& s) {
+  if (s.fail_count >= FAIL_LIMIT) {
+    if (s.filter.count() == 0)
+      return false; // already cleared
+    s.filter.clear();
+    return true;
+  } else {
+    s.fail_count++;
+    return false;
+  }
+}
+
+bool DS18B20Bus::check() {
+  if (_next >= _count) {
+    // conversion in progress (or nothing on the bus)
+    if (_count == 0 || !_timeout.check())
+      return false;
+    _next = 0;
+  }
+  // read one sensor per call to keep loop latency low
+  _changed |= update(_sensors[_next++]);
+  if (_next < _count)
+    return false;
+  // keep error of a failed sensor until a round reads all of them
+  if (!_failed)
+    _last_error = 0;
+  _failed = false;
+  startConversion();
+  bool result = _changed;
+  _changed = false;
+  return result;
+}
+
+bool DS18B20Bus::update(Sensor& s) {
+  int16_t val = DS18B20::NO_VAL;
+  if (!_wire.reset())
+    _last_error = 1;
+  else {
+    _wire.select(s.rom);
+    val = DS18B20::readScratchPad(_wire, _last_error);
+  }
+  if (val == DS18B20::NO_VAL) {
+    _failed = true;
+    return fail(s);
+  }
+  s.fail_count = 0;
+  s.filter.addRaw(val);
+  return true;
+}
+
+void DS18B20Bus::startConversion() {
+  _timeout.reset(TEMP_INTERVAL);
+  if (!_wire.reset()) {
+    _last_error = 3;
+    return; // sensors will fail on read
   }
-  _value = temp_t(((long)sum * temp_t::multiplier) / (count << 4));
+  _wire.skip();
+  _wire.write(0x44, 0); // start conversion on all sensors at once
 }
 
+uint8_t DS18B20Bus::getCount() {
+  return _count;
+}
+
+DS18B20Bus::temp_t DS18B20Bus::getTemp(uint8_t i) {
+  if (i >= _count)
+    return temp_t::invalid();
+  return _sensors[i].filter.getValue();
+}
+
+const uint8_t* DS18B20Bus::getAddress(uint8_t i) {
+  return _sensors[i].rom;
+}
+
+uint8_t DS18B20Bus::getLastError() {
+  return _last_error;
+}
@@ -15,6 +15,19 @@
      2 - DATA
      3 - VCC
 
+  DS18B20Bus class serves many sensors on one pin. Devices are found once with
+  1-Wire search, converted all together with a single Skip-ROM Convert-T
+  and read one by one with Match-ROM, so a round over N sensors costs
+  one conversion window instead of N. Sensor storage is given by the sketch:
+
+    DS18B20Bus::Sensor sensors[16];
+    DS18B20Bus bus(pin, sensors, 16);
+
+    bus.begin(); // in setup, returns number of sensors found
+    if (bus.check()) // in loop, true when a round was read
+      for (uint8_t i = 0; i < bus.getCount(); i++)
+        ... bus.getTemp(i) ...
+
   Author: Roman Elizarov
 */
 
@@ -25,10 +38,17 @@
 #include <OneWire.h>
 #include <Timeout.h>
 #include <FixNum.h>
+#include <TrimmedMean.h>
+
+// Number of readings in running average, one per second
+#ifndef DS18B20_WINDOW
+#define DS18B20_WINDOW 12
+#endif
 
 class DS18B20 {
 public:
   typedef fixnum16_2 temp_t;
+  typedef TrimmedMean<temp_t, DS18B20_WINDOW, 1, 16> filter_t; // raw reads are in 1/16 of degree Centigrade
 
   DS18B20(uint8_t pin);
 
@@ -37,24 +57,57 @@ public:
   uint8_t getLastError(); // last error code and status for debugging
 
 private:
-  static const uint8_t QUEUE_SIZE = 12;
+  friend class DS18B20Bus;
+
   static const int16_t NO_VAL = INT_MAX;
   
   OneWire _wire;
   Timeout _timeout;
-  uint8_t _index;
-  uint8_t _size;
-  int16_t _queue[QUEUE_SIZE]; // queue of raw reads in 1/16 of degree Centigrade
+  filter_t _filter;
   uint8_t _fail_count;
   uint8_t _last_error;
-  
-  temp_t _value; // computed value
 
-  void clear();
   bool fail();
   int16_t readScratchPad();
   bool startConversion();
-  void computeValue();
+
+  static int16_t readScratchPad(OneWire& wire, uint8_t& error);
+};
+
+class DS18B20Bus {
+public:
+  typedef DS18B20::temp_t temp_t;
+
+  // State of one sensor on the bus, fields are private to DS18B20Bus
+  struct Sensor {
+    uint8_t rom[8];
+    uint8_t fail_count;
+    DS18B20::filter_t filter;
+  };
+
+  DS18B20Bus(uint8_t pin, Sensor* sensors, uint8_t capacity);
+
+  uint8_t begin(); // searches the bus and starts conversion, returns number of sensors found
+  bool check(); // returns true when all sensors were read and a new conversion started
+  uint8_t getCount(); // number of sensors found by begin
+  temp_t getTemp(uint8_t i); // Returns value of i-th sensor in 1/100 of degree Centigrade (oversampling!)
+  const uint8_t* getAddress(uint8_t i); // 8-byte ROM code of i-th sensor
+  uint8_t getLastError(); // last error code and status for debugging
+
+private:
+  OneWire _wire;
+  Timeout _timeout;
+  Sensor* _sensors;
+  uint8_t _capacity;
+  uint8_t _count;
+  uint8_t _next; // next sensor to read, _count while conversion is in progress
+  bool _changed; // some sensor changed during this round
+  bool _failed;  // some sensor failed during this round
+  uint8_t _last_error;
+
+  bool fail(Sensor& s);
+  bool update(Sensor& s);
+  void startConversion();
 };
 
 #endif /* DS18B20_H_ */
@@ -0,0 +1,48 @@
+/*
+  Sample sketch for DS18B20Bus with many DS18B20 sensors on a single pin.
+
+  Author: Roman Elizarov
+*/
+
+#include <OneWire.h>
+#include <FixNum.h>
+#include <Timeout.h>
+#include <DS18B20.h>
+
+const uint8_t DS18B20_PIN = 8;
+const uint8_t MAX_SENSORS = 20;
+Timeout stateTimeout(Timeout::SECOND);
+
+DS18B20Bus::Sensor sensors[MAX_SENSORS];
+DS18B20Bus bus(DS18B20_PIN, sensors, MAX_SENSORS);
+
+void printAddress(const uint8_t* rom) {
+  for (uint8_t i = 0; i < 8; i++) {
+    if (rom[i] < 0x10)
+      Serial.print('0');
+    Serial.print(rom[i], HEX);
+  }
+}
+
+void setup() {
+  Serial.begin(57600);
+  Serial.println("=== DS18B20 Bus Test ===");
+  Serial.print("Found "); Serial.print(bus.begin()); Serial.println(" sensors");
+}
+
+void loop() {
+  if (bus.check()) {
+    Serial.println("--- DS18B20 Bus Test ---");
+    for (uint8_t i = 0; i < bus.getCount(); i++) {
+      printAddress(bus.getAddress(i));
+      Serial.print(" T = "); Serial.println(bus.getTemp(i).format());
+    }
+  }
+  // Print state periodically if there is some error
+  if (stateTimeout.check()) {
+    if (bus.getLastError() != 0) {
+      Serial.print("DS18B20 Bus Error = "); Serial.println(bus.getLastError(), HEX);
+    }
+    stateTimeout.reset(Timeout::SECOND);
+  }
+}
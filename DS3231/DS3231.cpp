@@ -1,7 +1,7 @@
 // See DS3231.h for credits
 
 #include "DS3231.h"
-#include <avr/pgmspace.h>
+#include <util/atomic.h>
 
 #define DS3231_ADDRESS	      0x68 //I2C Slave address
 
@@ -36,16 +36,24 @@
 ////////////////////////////////////////////////////////////////////////////////
 // utility code, some of this could be exposed in the DateTime API if needed
 
-static const uint8_t daysInMonth [] PROGMEM = { 31,28,31,30,31,30,31,31,30,31,30,31 };
+// Dates are counted in years starting from March 1st, so that the leap day is the last day
+// of a year and the days before each month follow (153 * month + 2) / 5 for March = 0.
+// Every fourth year is leap in 2000..2099, so four years are always 1461 days.
+// Days are counted from 1996/03/01 to keep them unsigned for Jan and Feb of 2000.
+#define DAYS_FROM_1996_03 1401
 
-// number of days since 2000/01/01, valid for 2001..2099 (y is 01 to 99)
+// number of days since 2000/01/01, valid for 2000..2099 (y is 00 to 99)
 static uint16_t date2days(uint8_t y, uint8_t m, uint8_t d) {
-  uint16_t days = d;
-  for (uint8_t i = 1; i < m; ++i)
-    days += pgm_read_byte(daysInMonth + i - 1);
-  if (m > 2 && y % 4 == 0)
-    ++days;
-  return days + 365 * y + (y + 3) / 4 - 1;
+  uint8_t yy = y + 4; // march-based years since 1996
+  uint8_t mp;         // march-based month
+  if (m > 2)
+    mp = m - 3;
+  else {
+    mp = m + 9;
+    yy--;
+  }
+  // unsigned, 365 * yy passes 32767 from 2090 and int is 16 bits on AVR
+  return 365U * yy + yy / 4 + (153U * mp + 2) / 5 + d - 1 - DAYS_FROM_1996_03;
 }
 
 static long time2long(uint16_t days, uint8_t h, uint8_t m, uint8_t s) {
@@ -71,28 +79,48 @@ static bool digit(char ch) {
 // NOTE: also ignores leap seconds, see http://en.wikipedia.org/wiki/Leap_second
 
 DateTime::DateTime(long t) {
-  ss = t % 60;
-  t /= 60;
-  mm = t % 60;
-  t /= 60;
-  hh = t % 24;
-  uint16_t days = t / 24;
-  uint8_t leap;
-  for (y = 0; ; ++y) {
-    leap = y % 4 == 0;
-    if (days < 365 + leap)
-      break;
-    days -= 365 + leap;
+  uint16_t days = (uint32_t)t / SECONDS_PER_DAY;
+  setSeconds((uint32_t)t - days * SECONDS_PER_DAY);
+  setDays(days);
+}
+
+void DateTime::setDays(uint16_t days) {
+  uint16_t n = days + DAYS_FROM_1996_03;
+  uint8_t q = n / 1461;         // four-year cycles since 1996
+  uint16_t r = n - q * 1461U;   // day in the cycle
+  uint8_t yr = (r - r / 1460) / 365; // year in the cycle, leap day is the last one
+  uint16_t doy = r - yr * 365U; // day in the march-based year
+  uint8_t mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  if (mp < 10)
+    m = mp + 3;
+  else {
+    m = mp - 9;
+    yr++;
   }
-  for (m = 1; ; ++m) {
-    uint8_t daysPerMonth = pgm_read_byte(daysInMonth + m - 1);
-    if (leap && m == 2)
-      ++daysPerMonth;
-    if (days < daysPerMonth)
-      break;
-    days -= daysPerMonth;
+  y = 4 * q + yr - 4;
+}
+
+void DateTime::setSeconds(uint32_t secs) {
+  hh = (uint16_t)(secs >> 4) / 225; // 3600 = 16 * 225, keeps division in 16 bits
+  uint16_t s = secs - hh * 3600U;
+  mm = s / 60;
+  ss = s - mm * 60;
+}
+
+void DateTime::convert(const long* t, DateTime* dt, uint16_t n) {
+  uint16_t prev = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    uint16_t days = (uint32_t)t[i] / SECONDS_PER_DAY;
+    dt[i].setSeconds((uint32_t)t[i] - days * SECONDS_PER_DAY);
+    if (i > 0 && days == prev) {
+      dt[i].y = dt[i - 1].y;
+      dt[i].m = dt[i - 1].m;
+      dt[i].d = dt[i - 1].d;
+    } else
+      dt[i].setDays(days);
+    prev = days;
   }
-  d = days + 1;
 }
 
 DateTime::DateTime (uint8_t year, uint8_t month, uint8_t date, uint8_t hour, uint8_t min, uint8_t sec) {
@@ -148,18 +176,22 @@ void DateTime::clear() {
   ss = 0;
 }
 
+void DateTime::format(char* pos) const {
+  formatPair(y, &pos[0]);
+  pos[2] = '-';
+  formatPair(m, &pos[3]);
+  pos[5] = '-';
+  formatPair(d, &pos[6]);
+  pos[8] = ' ';
+  formatPair(hh, &pos[9]);
+  pos[11] = ':';
+  formatPair(mm, &pos[12]);
+  pos[14] = ':';
+  formatPair(ss, &pos[15]);
+}
+
 DateTime::Str::Str(const DateTime& dt) {
-  formatDecimal(dt.year(), &_buf[0], 2, FMT_ZERO);
-  _buf[2] = '-';
-  formatDecimal(dt.month(), &_buf[3], 2, FMT_ZERO);
-  _buf[5] = '-';
-  formatDecimal(dt.date(), &_buf[6], 2, FMT_ZERO);
-  _buf[8] = ' ';
-  formatDecimal(dt.hour(), &_buf[9], 2, FMT_ZERO);
-  _buf[11] = ':';
-  formatDecimal(dt.minute(), &_buf[12], 2, FMT_ZERO);
-  _buf[14] = ':';
-  formatDecimal(dt.second(), &_buf[15], 2, FMT_ZERO);
+  dt.format(_buf);
   _buf[17] = 0;
 }
 
@@ -356,17 +388,9 @@ const uint8_t FAIL_LIMIT = 3;
 DS3231Temp::DS3231Temp() :
   _timeout(TEMP_INTERVAL)
 {
-  clear();
   startConversion();
 }
 
-void DS3231Temp::clear() {
-  for (uint8_t i = 0; i < QUEUE_SIZE; i++)
-    _queue[i] = NO_VAL;
-  _size = 0;
-  _temp.clear();
-}
-
 //force temperature sampling and converting to registers. If this function is not used the temperature is sampled once 64 Sec.
 bool DS3231Temp::startConversion() {
   // Set CONV 
@@ -381,9 +405,9 @@ bool DS3231Temp::startConversion() {
 
 bool DS3231Temp::fail() {
   if (_fail_count >= FAIL_LIMIT) {
-    if (_size == 0)
+    if (_filter.count() == 0)
       return false; // already cleared
-    clear();
+    _filter.clear();
     return true;
   } else {
     _fail_count++;
@@ -408,14 +432,7 @@ bool DS3231Temp::check() {
     result = fail();
   } else {
     _fail_count = 0;
-    // enqueue new value
-    _queue[_index++] = val;
-    if (_index == QUEUE_SIZE)
-      _index = 0;
-    if (_size < QUEUE_SIZE)
-      _size++;
-    // reset computed value
-    _temp.clear();
+    _filter.addRaw(val);
     result = true;
   }
   result |= startConversion();
@@ -423,30 +440,7 @@ bool DS3231Temp::check() {
 }
 
 DS3231Temp::temp_t DS3231Temp::getTemp() {
-  if (!_temp && _size > 0)
-    computeTemp();
-  return _temp;
-}
-
-void DS3231Temp::computeTemp() {
-  int hi = INT_MIN;
-  int lo = INT_MAX;
-  int sum = 0;
-  int count = 0;
-  for (uint8_t i = 0; i < QUEUE_SIZE; i++)
-    if (_queue[i] != NO_VAL) {
-      sum += _queue[i];
-      hi = max(hi, _queue[i]);
-      lo = min(lo, _queue[i]);
-      count++;
-    }
-  if (count > 2) {
-    // drop outliers for even higher precision
-    sum -= hi;
-    sum -= lo;
-    count -= 2;
-  }
-  _temp = temp_t(((long)sum * temp_t::multiplier) / (count << 2));
+  return _filter.getValue();
 }
 
 int16_t DS3231Temp::readTemp() {
@@ -457,3 +451,196 @@ int16_t DS3231Temp::readTemp() {
     return NO_VAL;
   return (int16_t(buf[0]) << 2) | (uint8_t(buf[1]) >> 6);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// DS3231Clock class for cached date-time
+
+const long CLOCK_RETRY = Timeout::SECOND;         // retry failed read of the chip
+const long CLOCK_MIN_RESYNC = 20 * Timeout::SECOND; // shortest resync interval, also first one to measure millis() rate
+const long CLOCK_MAX_TICKS_RESYNC = 12 * Timeout::HOUR; // 16-bit tick counter must not wrap between reads
+const uint8_t CLOCK_POLL = 10;         // ms between reads of seconds register when looking for second edge
+const uint8_t CLOCK_EDGE_GAP = 50;     // longest ms between two reads to take the change of seconds as the edge
+const uint16_t CLOCK_EDGE_WAIT = 3000; // give up looking for second edge after this many ms
+const uint16_t CLOCK_RATE_MIN = 950;   // millis() per second of the chip that are trusted as a measurement
+const uint16_t CLOCK_RATE_MAX = 1050;
+
+const uint8_t CLOCK_MILLIS = 0; // extrapolating from millis()
+const uint8_t CLOCK_EDGE   = 1; // extrapolating from millis() and looking for the next second edge
+const uint8_t CLOCK_TICKS  = 2; // counting tick() calls
+
+DS3231Clock::DS3231Clock(Timeout::type resync, uint16_t drift) :
+  _interval(resync),
+  _drift(drift),
+  _state(CLOCK_MILLIS),
+  _base(0),
+  _base_frac(0),
+  _period(1000UL << 8),
+  _base_ticks(0),
+  _measured(false),
+  _edge_seen(false),
+  _ticks(0)
+{
+  _resync.disable(); // read on first call
+}
+
+void DS3231Clock::tick() {
+  _ticks++;
+}
+
+uint16_t DS3231Clock::ticks() {
+  uint16_t t;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    t = _ticks;
+  }
+  return t;
+}
+
+void DS3231Clock::resync() {
+  _resync.disable();
+}
+
+bool DS3231Clock::adjust(const DateTime& dt) {
+  if (!DS3231::adjust(dt))
+    return false;
+  // writing seconds restarts chip countdown, so this is a second edge, too
+  unsigned long m = millis();
+  _base = dt.get();
+  _base_millis = m;
+  _base_frac = 0;
+  _base_ticks = ticks();
+  _edge_seen = true;
+  _edge = _base;
+  _edge_millis = m;
+  if (_state == CLOCK_EDGE)
+    _state = CLOCK_MILLIS;
+  _resync.reset(_measured ? _interval : CLOCK_MIN_RESYNC);
+  return true;
+}
+
+DateTime DS3231Clock::now() {
+  long t = nowSeconds();
+  if (t == 0)
+    return DateTime();
+  return DateTime(t);
+}
+
+long DS3231Clock::nowSeconds() {
+  if (_state != CLOCK_TICKS && _base != 0 && ticks() != _base_ticks) {
+    // tick() is being called, count ticks from now on
+    _state = CLOCK_TICKS;
+    _resync.disable();
+  }
+  if (!_resync.enabled() || _resync.check())
+    read();
+  else if (_state == CLOCK_EDGE)
+    poll();
+  if (_base == 0)
+    return 0;
+  if (_state == CLOCK_TICKS)
+    return _base + (uint16_t)(ticks() - _base_ticks);
+  return current();
+}
+
+// steps base one second of the chip at a time, usually once per second
+long DS3231Clock::current() {
+  unsigned long d = millis() - _base_millis;
+  for (;;) {
+    uint32_t next = _base_frac + _period;
+    if (d < (next >> 8))
+      return _base;
+    _base++;
+    _base_millis += next >> 8;
+    _base_frac = next;
+    d -= next >> 8;
+  }
+}
+
+void DS3231Clock::read() {
+  uint16_t tk = ticks();
+  DateTime dt = DS3231::now();
+  if (!dt) {
+    _resync.reset(CLOCK_RETRY); // keep extrapolating meanwhile
+    return;
+  }
+  long t = dt.get();
+  if (_state == CLOCK_TICKS) {
+    if (ticks() != tk) {
+      _resync.disable(); // tick during the read, retry to know which second it was
+      return;
+    }
+    _base = t;
+    _base_ticks = tk;
+    _resync.reset(min(_interval, CLOCK_MAX_TICKS_RESYNC));
+    return;
+  }
+  // Phase within the second is unknown until the seconds register changes,
+  // keep extrapolated time if it is still right, otherwise start from the read.
+  unsigned long m = millis();
+  long cur = _base != 0 ? current() : 0;
+  _poll_delay = CLOCK_POLL;
+  if (cur == t) {
+    // start reading seconds a drift limit before extrapolated edge
+    long wait = (long)(_base_millis + ((_base_frac + _period) >> 8) - m) - _drift - CLOCK_POLL;
+    if (wait > CLOCK_POLL)
+      _poll_delay = wait;
+  } else {
+    _base = t;
+    _base_millis = m;
+    _base_frac = 0;
+  }
+  _state = CLOCK_EDGE;
+  _read = t;
+  _read_millis = m;
+  _poll_millis = m;
+  _resync.reset(_measured ? _interval : CLOCK_MIN_RESYNC);
+}
+
+void DS3231Clock::poll() {
+  unsigned long m = millis();
+  if (m - _poll_millis < _poll_delay)
+    return;
+  _poll_delay = CLOCK_POLL;
+  uint8_t sec = bcd2bin(readRegister(DS3231_SEC_REG));
+  if (_last_error != 0) {
+    _state = CLOCK_MILLIS; // measure next time
+    return;
+  }
+  uint8_t passed = (sec + 60 - _read % 60) % 60;
+  if (passed == 1 && m - _poll_millis <= CLOCK_EDGE_GAP) {
+    edge(_read + 1, m - (m - _poll_millis) / 2); // it was somewhere between the two reads
+    return;
+  }
+  _read += passed; // edge between reads too far apart, wait for the next one
+  _poll_millis = m;
+  if (m - _read_millis > CLOCK_EDGE_WAIT)
+    _state = CLOCK_MILLIS; // not called often enough or the chip is stopped
+}
+
+// second edge of time t was seen at millis m
+void DS3231Clock::edge(long t, unsigned long m) {
+  Timeout::type next = _measured ? _interval : CLOCK_MIN_RESYNC;
+  long s = t - _edge;
+  unsigned long ms = m - _edge_millis;
+  if (_edge_seen && s > 0 && ms / s >= CLOCK_RATE_MIN && ms / s < CLOCK_RATE_MAX) {
+    // error of extrapolation with the old period since the last edge
+    long err = ms - s * (_period >> 8) - ((s * (_period & 0xff)) >> 8);
+    if (err < 0)
+      err = -err;
+    _period = ((ms / s) << 8) + ((ms % s) << 8) / s;
+    _measured = true;
+    // time to be off by _drift if the rate changes as much again, or
+    // because of the error of edge times in the new _period
+    Timeout::type limit = ms / (2 * CLOCK_POLL) * _drift;
+    if (err > 0)
+      limit = min(limit, (Timeout::type)(ms / err * _drift));
+    next = max(min(limit, _interval), CLOCK_MIN_RESYNC);
+  }
+  _base = t;
+  _base_millis = m;
+  _base_frac = 0;
+  _edge_seen = true;
+  _edge = t;
+  _edge_millis = m;
+  _state = CLOCK_MILLIS;
+  _resync.reset(next);
+}
@@ -31,6 +31,7 @@
 #include <TWIMaster.h>
 #include <Timeout.h>
 #include <FixNum.h>
+#include <TrimmedMean.h>
 
 // periodicity constants for enableInterrupts(uint8_t periodicity)
 const uint8_t EverySecond = 0x01;
@@ -78,10 +79,17 @@ public:
 
   // formatting
   inline Str format() const { return Str(*this); }
+  void format(char* pos) const; // writes sizeof(str_t) - 1 chars, no terminating zero
+
+  // converts n times at once, consecutive times of the same day reuse the date
+  static void convert(const long* t, DateTime* dt, uint16_t n);
 
 private:
     uint8_t y, m, d, hh, mm, ss;
 
+    void setDays(uint16_t days);       // date from days since 1/1/2000
+    void setSeconds(uint32_t secs);    // time of day from seconds since midnight
+
     friend class DateTimeParser;
 };
 
@@ -131,9 +139,15 @@ protected:
 // ========================================================================
 // DS3231Temp class for oversampled temperature
 
+// Number of readings in running average, one per second
+#ifndef DS3231_TEMP_WINDOW
+#define DS3231_TEMP_WINDOW 12
+#endif
+
 class DS3231Temp : public DS3231 {
 public:
   typedef fixnum16_2 temp_t;
+  typedef TrimmedMean<temp_t, DS3231_TEMP_WINDOW, 1, 4> filter_t; // raw reads are in 1/4 of degree Centigrade
 
   DS3231Temp();
 
@@ -141,21 +155,71 @@ public:
   temp_t getTemp(); // get current temperature reading
 
 private:
-  static const uint8_t QUEUE_SIZE = 12;
   static const int16_t NO_VAL = 0x7fff;
   
   Timeout _timeout;
-  uint8_t _index;
-  uint8_t _size;
-  int16_t _queue[QUEUE_SIZE]; // queue of raw reads in 1/4 of degree Centigrade
+  filter_t _filter;
   uint8_t _fail_count;
-  temp_t _temp;
 
-  void clear();
   bool startConversion();
   bool fail();
-  void computeTemp();
   int16_t readTemp();
 };
 
+// ========================================================================
+// DS3231Clock class for cached date-time that does not read the chip on every call.
+// Time is read once and then extrapolated from millis() or counted by tick() from
+// 1 Hz interrupt handler (see enableInterrupts(EverySecond)). Each read also finds the
+// next change of the seconds register to measure millis() per second of the chip, which
+// corrects later extrapolation. The chip is read again after resync interval, or sooner
+// when the error measured on the last read would reach drift limit.
+
+// Default interval between reads of the chip
+#ifndef DS3231_CLOCK_RESYNC
+#define DS3231_CLOCK_RESYNC Timeout::HOUR
+#endif
+
+// Default limit of extrapolation error in ms
+#ifndef DS3231_CLOCK_DRIFT
+#define DS3231_CLOCK_DRIFT 200
+#endif
+
+class DS3231Clock : public DS3231 {
+public:
+  DS3231Clock(Timeout::type resync = DS3231_CLOCK_RESYNC, uint16_t drift = DS3231_CLOCK_DRIFT);
+
+  bool adjust(const DateTime& dt);  // Changes the date-time of the chip and of the cache
+  DateTime now();                   // Gets the current date-time, reads the chip only on resync
+  long nowSeconds();                // Same as now().get() without DateTime conversion, zero when unknown
+
+  void resync();                    // read the chip on the next call
+  void tick();                      // call from 1 Hz interrupt handler to count seconds instead of millis()
+
+private:
+  Timeout::type _interval;  // configured resync interval
+  uint16_t _drift;          // configured drift limit
+  Timeout _resync;
+  uint8_t _state;
+  long _base;               // time in seconds at _base_millis or _base_ticks, zero when unknown
+  unsigned long _base_millis;
+  uint8_t _base_frac;       // fraction of _base_millis in 1/256 ms
+  uint32_t _period;         // millis() per second of the chip in 1/256 ms
+  uint16_t _base_ticks;
+  bool _measured;           // _period was measured between two second edges
+  bool _edge_seen;          // _edge and _edge_millis are set
+  long _edge;               // time of the last second edge seen
+  unsigned long _edge_millis;
+  long _read;               // time read from the chip while looking for its next second edge
+  unsigned long _read_millis;
+  unsigned long _poll_millis;
+  uint16_t _poll_delay;     // ms from _poll_millis to the next read of seconds
+  volatile uint16_t _ticks; // seconds counted by tick()
+
+  uint16_t ticks();
+  long current();
+  void read();
+  void poll();
+  void edge(long t, unsigned long m);
+};
+
 #endif
@@ -0,0 +1,24 @@
+/*
+  Sample sketch for DS3231 library that checks time on every loop, but
+  reads the chip only once in a while and prints time when a second changes.
+ */
+
+#include <TWIMaster.h>
+#include <Timeout.h>
+#include <FixNum.h>
+#include <DS3231.h>
+
+DS3231Clock rtc;
+long last;
+
+void setup () {
+  Serial.begin(57600);
+}
+
+void loop () {
+  long t = rtc.nowSeconds(); //get the current time in seconds
+  if (t != last) {
+    last = t;
+    Serial.println(rtc.now().format());
+  }
+}
@@ -73,6 +73,21 @@
  * data to the next available area in the flash segment. If there isn't room for a new copy then the
  * sector is erased, the size and new bitmap are written, followed by the data.
  *
+ * ## Delta layout
+ * When begin() is called with delta set, only the changed parts of the data are written by commit().
+ *
+ * - 4 bytes - size of a block with EEPROM_DELTA_FLAG set
+ * - full copy of the data
+ * - delta records follow consecutively, each is a 4 byte header holding the offset and
+ *   length of a changed range followed by the changed bytes (4 byte aligned)
+ * - each commit() writes one record per changed range and then a 4 byte commit mark
+ *
+ * The begin() call reads the full copy and then applies the records of each commit that
+ * has its mark.  A commit interrupted before its mark is written is ignored as a whole,
+ * and the next commit() erases the sector as it is no longer clean after the last mark.
+ * Only when there is no room for the next records is the sector erased and a new full copy
+ * written.  This suits a larger block of data where only a few bytes change between commits.
+ *
  * ## When to use
  * Most of the time we need a small amount to EEPROM memory to retain settings
  * between re-boots of the system.
@@ -96,6 +111,38 @@ extern "C" {
 
 extern "C" uint32_t _SPIFFS_end;
 
+/** State of a word of flash after erase */
+static const uint32_t ERASED_WORD = 0xFFFFFFFF;
+
+//------------------------------------------------------------------------------
+// Delta record header - 12 bits of offset, 12 bits of length and an 8 bit check
+static uint32_t deltaHeader(uint16_t offset, uint16_t length) {
+	uint8_t check = ~(offset + length);
+	return offset | ((uint32_t) length << 12) | ((uint32_t) check << 24);
+}
+
+// Written after the records of a commit, a zero length is never used by a record
+static const uint32_t DELTA_COMMIT_MARK = deltaHeader(0, 0);
+
+//------------------------------------------------------------------------------
+// Check if a 4 byte word of data is flagged as changed
+static bool isDirtyWord(const uint8_t* map, uint16_t word) {
+	return (map[word >> 3] & (1 << (word & 7))) != 0;
+}
+
+//------------------------------------------------------------------------------
+// Find the end of a run of changed words starting at word.  A single unchanged word
+// is included in the run as it costs the same as the header of a new record.
+static uint16_t dirtyRunEnd(const uint8_t* map, uint16_t word, uint16_t words) {
+	uint16_t end = word + 1;
+	while (end < words
+			&& (isDirtyWord(map, end)
+					|| (end + 1 < words && isDirtyWord(map, end + 1)))) {
+		end++;
+	}
+	return end;
+}
+
 //------------------------------------------------------------------------------
 /**
  * Create an instance of the EEPROM class at using a specified sector of flash memory.
@@ -107,7 +154,7 @@ extern "C" uint32_t _SPIFFS_end;
  */
 EEPROMClass::EEPROMClass(uint32_t sector) :
 		_sector(sector), _data(0), _size(0), _bitmapSize(0), _bitmap(0), _offset(
-				0), _dirty(false) {
+				0), _dirty(false), _delta(false), _dirtyMap(0) {
 }
 
 //------------------------------------------------------------------------------
@@ -133,7 +180,7 @@ EEPROMClass::EEPROMClass(uint32_t sector) :
 EEPROMClass::EEPROMClass(void) :
 		_sector((((uint32_t) & _SPIFFS_end - 0x40200000) / SPI_FLASH_SEC_SIZE)), _data(
 				0), _size(0), _bitmapSize(0), _bitmap(0), _offset(0), _dirty(
-				false) {
+				false), _delta(false), _dirtyMap(0) {
 }
 
 //------------------------------------------------------------------------------
@@ -154,9 +201,14 @@ EEPROMClass::EEPROMClass(void) :
  * Nothing is written to the flash until you call the commit() function, which will erase
  * the sector and write the new data.
  *
+ * If the flash holds data of the correct size in the other layout (delta or not) then
+ * the data is read but the next commit() erases the sector and rewrites the data
+ * in the requested layout.
+ *
  * @param size
+ * @param delta If true then commit() only writes the changed bytes as delta records
  */
-void EEPROMClass::begin(size_t size) {
+void EEPROMClass::begin(size_t size, bool delta) {
 	_dirty = true;
 	if (size <= 0 || size > (SPI_FLASH_SEC_SIZE - 8)) {
 		// max size is smaller by 4 bytes for size and 4 byte bitmap - to keep 4 byte aligned
@@ -167,28 +219,33 @@ void EEPROMClass::begin(size_t size) {
 
 	size = (size + 3) & ~3; // align to 4 bytes
 	_bitmapSize = computeBitmapSize(size);
+	_size = size;
+	_delta = delta;
+	_offset = 0;    // offset of zero => flash data is garbage
 
 	// drop any old allocation and re-allocate buffers
-	if (_bitmap) {
-		delete[] _bitmap;
-	}
-	_bitmap = new uint8_t[_bitmapSize];
-	if (_data) {
-		delete[] _data;
-	}
-	_data = new uint8_t[size];
+	allocateBuffers();
 
+	uint32_t flashSize;
 	noInterrupts();
 	spi_flash_read(_sector * SPI_FLASH_SEC_SIZE,
-			reinterpret_cast<uint32_t*>(&_size), 4);
+			reinterpret_cast<uint32_t*>(&flashSize), 4);
 	interrupts();
 
-	if (_size != size) {
-		// flash structure is all wrong - will need to re-do
-		_size = size;
-		_offset = 0;    // offset of zero => flash data is garbage
+	if (flashSize == (size | EEPROM_DELTA_FLAG)) {
+		// Full copy of the data followed by delta records
+		noInterrupts();
+		spi_flash_read(_sector * SPI_FLASH_SEC_SIZE + 4,
+				reinterpret_cast<uint32_t*>(_data), _size);
+		interrupts();
 
-	} else {
+		uint16_t offset = replayDelta();
+		if (_delta) {
+			// all good
+			_offset = offset;
+			_dirty = false;
+		}
+	} else if (flashSize == size) {
 		// Size is correct so get bitmap/data from flash
 		// First read the bitmap from flash
 		noInterrupts();
@@ -197,20 +254,19 @@ void EEPROMClass::begin(size_t size) {
 		interrupts();
 
 		// flash should contain a good version of the data - find it using the bitmap
-		_offset = offsetFromBitmap();
+		uint16_t offset = offsetFromBitmap();
 
-		if (_offset == 0 || _offset + _size > SPI_FLASH_SEC_SIZE) {
-			// something is screwed up
-			// flag that _data[] is bad / uninitialised
-			_offset = 0;
-		} else {
+		if (offset != 0 && offset + _size <= SPI_FLASH_SEC_SIZE) {
 			noInterrupts();
-			spi_flash_read(_sector * SPI_FLASH_SEC_SIZE + _offset,
+			spi_flash_read(_sector * SPI_FLASH_SEC_SIZE + offset,
 					reinterpret_cast<uint32_t*>(_data), _size);
 			interrupts();
 
-			// all good
-			_dirty = false;
+			if (!_delta) {
+				// all good
+				_offset = offset;
+				_dirty = false;
+			}
 		}
 	}
 }
@@ -234,7 +290,9 @@ void EEPROMClass::begin(size_t size) {
 int EEPROMClass::percentUsed() {
 	if (_offset == 0 || _size == 0)
 		return -1;
-	else {
+	else if (_delta) {
+		return (100 * _offset) / SPI_FLASH_SEC_SIZE;
+	} else {
 		int nCopies = (SPI_FLASH_SEC_SIZE - 4 - _bitmapSize) / _size;
 		int copyNo = 1 + (_offset - 4 - _bitmapSize) / _size;
 		return (100 * copyNo) / nCopies;
@@ -256,8 +314,12 @@ void EEPROMClass::end() {
 	if (_bitmap) {
 		delete[] _bitmap;
 	}
+	if (_dirtyMap) {
+		delete[] _dirtyMap;
+	}
 	_bitmap = 0;
 	_bitmapSize = 0;
+	_dirtyMap = 0;
 	_data = 0;
 	_size = 0;
 	_dirty = false;
@@ -303,6 +365,7 @@ void EEPROMClass::write(int const address, uint8_t const value) {
 	if (_data[address] != value) {
 		_data[address] = value;
 		_dirty = true;
+		markDirty(address, 1);
 	}
 }
 
@@ -330,6 +393,7 @@ bool EEPROMClass::commitReset() {
  * Write the EEPROM data to the flash memory.
  *
  * The flash segment for EEPROM data is erased if necessary before performing the write.
+ * With the delta layout only the changed bytes are written unless the sector is full.
  * The library maintains a record of whether the buffer has been changed and the write
  * to flash is only performed if the flash does not yet have a copy of the data or
  * if the data in the buffer has changed from what is stored in the flash memory.
@@ -338,7 +402,13 @@ bool EEPROMClass::commitReset() {
  */
 bool EEPROMClass::commit() {
 	// everything has to be in place to even try a commit
-	if (!_size || !_dirty || !_data || !_bitmap || _bitmapSize == 0) {
+	if (!_size || !_dirty || !_data) {
+		return false;
+	}
+	if (_delta) {
+		return commitDelta();
+	}
+	if (!_bitmap || _bitmapSize == 0) {
 		return false;
 	}
 
@@ -423,14 +493,7 @@ bool EEPROMClass::wipe() {
 		return false;      // must have called begin()
 
 	// drop any old allocation and re-allocate buffers
-	if (_bitmap) {
-		delete[] _bitmap;
-	}
-	_bitmap = new uint8_t[_bitmapSize];
-	if (_data) {
-		delete[] _data;
-	}
-	_data = new uint8_t[_size];
+	allocateBuffers();
 
 	noInterrupts();
 	SpiFlashOpResult flashOk = spi_flash_erase_sector(_sector);
@@ -520,6 +583,238 @@ uint16_t EEPROMClass::computeBitmapSize(size_t size) {
 	return bitmapSize & 0x7fff;
 }
 
+//------------------------------------------------------------------------------
+/**
+ * Drop any old allocation and allocate the buffers for the current size
+ */
+void EEPROMClass::allocateBuffers() {
+	if (_bitmap) {
+		delete[] _bitmap;
+	}
+	_bitmap = new uint8_t[_bitmapSize];
+	if (_data) {
+		delete[] _data;
+	}
+	_data = new uint8_t[_size];
+	if (_dirtyMap) {
+		delete[] _dirtyMap;
+		_dirtyMap = 0;
+	}
+	if (_delta) {
+		// one bit for each 4 byte word of data
+		size_t mapSize = ((_size >> 2) + 7) >> 3;
+		_dirtyMap = new uint8_t[mapSize];
+		memset(_dirtyMap, 0, mapSize);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Flag the 4 byte words holding a range of data as changed for the next delta commit
+ *
+ * @param address The offset of the first changed byte
+ * @param count The number of changed bytes
+ */
+void EEPROMClass::markDirty(int address, size_t count) {
+	if (!_dirtyMap || count == 0)
+		return;
+
+	for (int word = address >> 2; word <= (int) ((address + count - 1) >> 2);
+			word++) {
+		_dirtyMap[word >> 3] |= 1 << (word & 7);
+	}
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Write the changed data as delta records after the last record in flash
+ *
+ * The sector is erased and a full copy written if there is no room for the records.
+ *
+ * @return True if successful; false if the write was unsuccessful.
+ */
+bool EEPROMClass::commitDelta() {
+	if (!_dirtyMap) {
+		return false;
+	}
+
+	// flash needed for a header and the data of each run of changed words and the mark
+	uint16_t words = _size >> 2;
+	uint32_t needed = 4;
+	for (uint16_t word = 0; word < words; word++) {
+		if (isDirtyWord(_dirtyMap, word)) {
+			uint16_t end = dirtyRunEnd(_dirtyMap, word, words);
+			needed += 4 + ((end - word) << 2);
+			word = end;
+		}
+	}
+
+	// If initial version, reset requested or not enough room for records, erase and start anew
+	if (_offset == 0 || _offset >= SPI_FLASH_SEC_SIZE
+			|| _offset + needed > SPI_FLASH_SEC_SIZE) {
+		return compactDelta();
+	}
+
+	SpiFlashOpResult flashOk = SPI_FLASH_RESULT_OK;
+	for (uint16_t word = 0; word < words; word++) {
+		if (!isDirtyWord(_dirtyMap, word)) {
+			continue;
+		}
+		uint16_t end = dirtyRunEnd(_dirtyMap, word, words);
+		uint16_t offset = word << 2;
+		uint16_t length = (end - word) << 2;
+
+		noInterrupts();
+		flashOk = spi_flash_write(_sector * SPI_FLASH_SEC_SIZE + _offset + 4,
+				reinterpret_cast<uint32_t*>(_data + offset), length);
+		interrupts();
+		if (flashOk != SPI_FLASH_RESULT_OK) {
+			// partly written record - force erase on next commit
+			_offset = SPI_FLASH_SEC_SIZE;
+			return false;
+		}
+
+		uint32_t header = deltaHeader(offset, length);
+		noInterrupts();
+		flashOk = spi_flash_write(_sector * SPI_FLASH_SEC_SIZE + _offset,
+				&header, 4);
+		interrupts();
+		if (flashOk != SPI_FLASH_RESULT_OK) {
+			_offset = SPI_FLASH_SEC_SIZE;
+			return false;
+		}
+
+		_offset += 4 + length;
+		word = end;
+	}
+
+	// records are only used once the mark is written after them
+	uint32_t mark = DELTA_COMMIT_MARK;
+	noInterrupts();
+	flashOk = spi_flash_write(_sector * SPI_FLASH_SEC_SIZE + _offset, &mark, 4);
+	interrupts();
+	if (flashOk != SPI_FLASH_RESULT_OK) {
+		_offset = SPI_FLASH_SEC_SIZE;
+		return false;
+	}
+	_offset += 4;
+
+	// all good!
+	memset(_dirtyMap, 0, ((words + 7) >> 3));
+	_dirty = false;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Erase the sector and write a full copy of the data in the delta layout
+ *
+ * @return True if successful; false if the write was unsuccessful.
+ */
+bool EEPROMClass::compactDelta() {
+	noInterrupts();
+	SpiFlashOpResult flashOk = spi_flash_erase_sector(_sector);
+	interrupts();
+	if (flashOk != SPI_FLASH_RESULT_OK) {
+		return false;
+	}
+	// the sector no longer holds the previous data
+	_offset = 0;
+
+	noInterrupts();
+	flashOk = spi_flash_write(_sector * SPI_FLASH_SEC_SIZE + 4,
+			reinterpret_cast<uint32_t*>(_data), _size);
+	interrupts();
+	if (flashOk != SPI_FLASH_RESULT_OK) {
+		return false;
+	}
+
+	// size is written last so that an incomplete copy is never used
+	uint32_t flashSize = _size | EEPROM_DELTA_FLAG;
+	noInterrupts();
+	flashOk = spi_flash_write(_sector * SPI_FLASH_SEC_SIZE, &flashSize, 4);
+	interrupts();
+	if (flashOk != SPI_FLASH_RESULT_OK) {
+		return false;
+	}
+
+	_offset = 4 + _size;
+	memset(_dirtyMap, 0, (((_size >> 2) + 7) >> 3));
+	_dirty = false;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Apply the delta records of complete commits in flash to the data buffer
+ *
+ * Headers are checked up to the last commit mark first, so that the records of
+ * an interrupted commit are not applied.
+ *
+ * @return The offset for the next record, or the sector size if the flash after
+ * the last commit mark is not erased and the sector needs to be erased on the next commit
+ */
+uint16_t EEPROMClass::replayDelta() {
+	uint16_t start = 4 + _size;
+	uint16_t committed = start;
+	uint16_t offset = start;
+	while (offset + 4 <= SPI_FLASH_SEC_SIZE) {
+		uint32_t header;
+		noInterrupts();
+		spi_flash_read(_sector * SPI_FLASH_SEC_SIZE + offset, &header, 4);
+		interrupts();
+		if (header == DELTA_COMMIT_MARK) {
+			offset += 4;
+			committed = offset;
+			continue;
+		}
+
+		uint16_t recordOffset = header & 0xFFF;
+		uint16_t length = (header >> 12) & 0xFFF;
+		if (header != deltaHeader(recordOffset, length) || length == 0
+				|| ((recordOffset | length) & 3) != 0
+				|| recordOffset + length > _size
+				|| offset + 4 + length > SPI_FLASH_SEC_SIZE) {
+			// erased, or a record of an interrupted commit
+			break;
+		}
+		offset += 4 + length;
+	}
+
+	for (offset = start; offset < committed;) {
+		uint32_t header;
+		noInterrupts();
+		spi_flash_read(_sector * SPI_FLASH_SEC_SIZE + offset, &header, 4);
+		interrupts();
+		uint16_t length = (header >> 12) & 0xFFF;
+		if (header != DELTA_COMMIT_MARK) {
+			noInterrupts();
+			spi_flash_read(_sector * SPI_FLASH_SEC_SIZE + offset + 4,
+					reinterpret_cast<uint32_t*>(_data + (header & 0xFFF)), length);
+			interrupts();
+		}
+		offset += 4 + length;
+	}
+
+	// an interrupted commit may have left records or data without a mark - check rest is erased
+	uint32_t buf[8];
+	for (uint16_t at = committed; at < SPI_FLASH_SEC_SIZE; at += sizeof(buf)) {
+		uint16_t n = SPI_FLASH_SEC_SIZE - at;
+		if (n > sizeof(buf)) {
+			n = sizeof(buf);
+		}
+		noInterrupts();
+		spi_flash_read(_sector * SPI_FLASH_SEC_SIZE + at, buf, n);
+		interrupts();
+		for (uint16_t i = 0; i < (n >> 2); i++) {
+			if (buf[i] != ERASED_WORD) {
+				return SPI_FLASH_SEC_SIZE;
+			}
+		}
+	}
+	return committed;
+}
+
 //------------------------------------------------------------------------------
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_EEPROM)
 EEPROMClass EEPROM;
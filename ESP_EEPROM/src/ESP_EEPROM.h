@@ -32,12 +32,17 @@
  */
 const size_t EEPROM_MIN_SIZE = 16;
 
+/** Flag set in the size word at the start of the flash sector when the data is held
+ * as a full image followed by a log of delta records
+ */
+const uint32_t EEPROM_DELTA_FLAG = 0x80000000;
+
 class EEPROMClass {
 public:
 
 	EEPROMClass(void);
 
-	void begin(size_t size);
+	void begin(size_t size, bool delta = false);
 	uint8_t read(int const address);
 	void write(int const address, uint8_t const val);
 	bool commit();
@@ -88,12 +93,11 @@ public:
 	const T &put(int const address, const T &v) {
 		if (_data && (address >= 0) && (address + sizeof(T) <= _size)) {
 
-			// only flag as dirty and copied if different - if already dirty, just get on with copy
-			if (_dirty
-					|| memcmp(_data + address, (const uint8_t*) &v, sizeof(T))
-							!= 0) {
+			// only flag as dirty and copied if different
+			if (memcmp(_data + address, (const uint8_t*) &v, sizeof(T)) != 0) {
 				_dirty = true;
 				memcpy(_data + address, (const uint8_t*) &v, sizeof(T));
+				markDirty(address, sizeof(T));
 			}
 		}
 		return v;
@@ -118,10 +122,17 @@ private:
 	uint8_t* _bitmap;
 	uint16_t _offset;
 	bool _dirty;
+	bool _delta;
+	uint8_t* _dirtyMap;
 
 	uint16_t offsetFromBitmap();
 	int flagUsedOffset();
 	uint16_t computeBitmapSize(size_t size);
+	void markDirty(int address, size_t count);
+	bool commitDelta();
+	bool compactDelta();
+	uint16_t replayDelta();
+	void allocateBuffers();
 };
 
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_EEPROM)
@@ -281,13 +281,8 @@ uint8_t DhcpClass::parseDHCPResponse(unsigned long responseTimeout, uint32_t& tr
 
         memcpy(_dhcpLocalIp, fixedMsg.yiaddr, 4);
 
-        // Skip to the option part
-        // Doing this a byte at a time so we don't have to put a big buffer
-        // on the stack (as we don't have lots of memory lying around)
-        for (int i =0; i < (240 - (int)sizeof(RIP_MSG_FIXED)); i++)
-        {
-            _dhcpUdpSocket.read(); // we don't care about the returned byte
-        }
+        // Skip to the option part, no need to read it out of the chip
+        _dhcpUdpSocket.skip(240 - sizeof(RIP_MSG_FIXED));
 
         while (_dhcpUdpSocket.available() > 0) 
         {
@@ -312,19 +307,15 @@ uint8_t DhcpClass::parseDHCPResponse(unsigned long responseTimeout, uint32_t& tr
                 case routersOnSubnet :
                     opt_len = _dhcpUdpSocket.read();
                     _dhcpUdpSocket.read(_dhcpGatewayIp, 4);
-                    for (int i = 0; i < opt_len-4; i++)
-                    {
-                        _dhcpUdpSocket.read();
-                    }
+                    if (opt_len > 4)
+                        _dhcpUdpSocket.skip(opt_len-4);
                     break;
                 
                 case dns :
                     opt_len = _dhcpUdpSocket.read();
                     _dhcpUdpSocket.read(_dhcpDnsServerIp, 4);
-                    for (int i = 0; i < opt_len-4; i++)
-                    {
-                        _dhcpUdpSocket.read();
-                    }
+                    if (opt_len > 4)
+                        _dhcpUdpSocket.skip(opt_len-4);
                     break;
                 
                 case dhcpServerIdentifier :
@@ -338,10 +329,7 @@ uint8_t DhcpClass::parseDHCPResponse(unsigned long responseTimeout, uint32_t& tr
                     else
                     {
                         // Skip over the rest of this option
-                        while (opt_len--)
-                        {
-                            _dhcpUdpSocket.read();
-                        }
+                        _dhcpUdpSocket.skip(opt_len);
                     }
                     break;
 
@@ -367,10 +355,7 @@ uint8_t DhcpClass::parseDHCPResponse(unsigned long responseTimeout, uint32_t& tr
                 default :
                     opt_len = _dhcpUdpSocket.read();
                     // Skip over the rest of this option
-                    while (opt_len--)
-                    {
-                        _dhcpUdpSocket.read();
-                    }
+                    _dhcpUdpSocket.skip(opt_len);
                     break;
             }
         }
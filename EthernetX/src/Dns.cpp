@@ -47,6 +47,113 @@
 #define INVALID_SERVER   -2
 #define TRUNCATED        -3
 #define INVALID_RESPONSE -4
+#define NAME_ERROR       -7
+
+#if DNS_CACHE_SIZE > 0
+// Identifies a host name without storing it; with both hashes and the length
+// a false hit needs two different names to collide on all three
+struct DNSCacheKey
+{
+    uint32_t hash;    // FNV-1a hash of the lower-cased host name
+    uint32_t hash2;   // djb2 hash of the lower-cased host name
+    uint16_t length;  // Length of the host name
+};
+
+struct DNSCacheEntry
+{
+    DNSCacheKey key;
+    uint32_t address; // Resolved address, 0 for a name that does not exist
+    uint32_t stamp;   // millis() when the entry was stored
+    uint16_t ttl;     // Lifetime in seconds, 0 for an unused entry
+};
+
+static DNSCacheEntry dnsCache[DNS_CACHE_SIZE];
+
+static DNSCacheKey hostKey(const char* aHostname)
+{
+    DNSCacheKey key;
+    key.hash = 2166136261UL;
+    key.hash2 = 5381;
+    key.length = 0;
+    while (*aHostname)
+    {
+        char c = *aHostname++;
+        if (c >= 'A' && c <= 'Z')
+        {
+            c += 'a' - 'A';
+        }
+        key.hash = (key.hash ^ (uint8_t)c) * 16777619UL;
+        key.hash2 = key.hash2 * 33 + (uint8_t)c;
+        key.length++;
+    }
+    return key;
+}
+
+static bool sameKey(const DNSCacheKey& aLeft, const DNSCacheKey& aRight)
+{
+    return aLeft.hash == aRight.hash && aLeft.hash2 == aRight.hash2 &&
+           aLeft.length == aRight.length;
+}
+
+// Milliseconds left before the entry expires, 0 if it is unused or expired
+static uint32_t cacheRemaining(const DNSCacheEntry& aEntry, uint32_t aNow)
+{
+    uint32_t lifetime = aEntry.ttl * 1000UL;
+    uint32_t age = aNow - aEntry.stamp;
+    return age < lifetime ? lifetime - age : 0;
+}
+
+static DNSCacheEntry* cacheLookup(const DNSCacheKey& aKey)
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < DNS_CACHE_SIZE; i++)
+    {
+        if (dnsCache[i].ttl != 0 && sameKey(dnsCache[i].key, aKey))
+        {
+            if (cacheRemaining(dnsCache[i], now) != 0)
+            {
+                return &dnsCache[i];
+            }
+            dnsCache[i].ttl = 0;
+        }
+    }
+    return NULL;
+}
+
+static void cacheStore(const DNSCacheKey& aKey, uint32_t aAddress, uint32_t aTtl)
+{
+    if (aTtl == 0)
+    {
+        return;
+    }
+    if (aTtl > DNS_CACHE_MAX_TTL)
+    {
+        aTtl = DNS_CACHE_MAX_TTL;
+    }
+    // Reuse the entry for this name, or else the one closest to expiry
+    uint32_t now = millis();
+    uint8_t slot = 0;
+    uint32_t slotRemaining = 0xFFFFFFFFUL;
+    for (uint8_t i = 0; i < DNS_CACHE_SIZE; i++)
+    {
+        if (sameKey(dnsCache[i].key, aKey))
+        {
+            slot = i;
+            break;
+        }
+        uint32_t remaining = cacheRemaining(dnsCache[i], now);
+        if (remaining < slotRemaining)
+        {
+            slot = i;
+            slotRemaining = remaining;
+        }
+    }
+    dnsCache[slot].key = aKey;
+    dnsCache[slot].address = aAddress;
+    dnsCache[slot].stamp = now;
+    dnsCache[slot].ttl = aTtl;
+}
+#endif
 
 void DNSClient::begin(const IPAddress& aDNSServer)
 {
@@ -106,6 +213,21 @@ int DNSClient::getHostByName(const char* aHostname, IPAddress& aResult)
         return 1;
     }
 
+#if DNS_CACHE_SIZE > 0
+    // See if we've looked it up recently
+    DNSCacheKey key = hostKey(aHostname);
+    DNSCacheEntry* entry = cacheLookup(key);
+    if (entry)
+    {
+        if (entry->address == 0)
+        {
+            return NAME_ERROR;
+        }
+        aResult = entry->address;
+        return SUCCESS;
+    }
+#endif
+
     // Check we've got a valid DNS server to use
     if (iDNSServer == INADDR_NONE)
     {
@@ -133,12 +255,23 @@ int DNSClient::getHostByName(const char* aHostname, IPAddress& aResult)
                     {
                         // Now wait for a response
                         int wait_retries = 0;
+                        uint32_t ttl = 0;
                         ret = TIMED_OUT;
                         while ((wait_retries < 3) && (ret == TIMED_OUT))
                         {
-                            ret = ProcessResponse(5000, aResult);
+                            ret = ProcessResponse(5000, aResult, ttl);
                             wait_retries++;
                         }
+#if DNS_CACHE_SIZE > 0
+                        if (ret == SUCCESS)
+                        {
+                            cacheStore(key, aResult, ttl);
+                        }
+                        else if (ret == NAME_ERROR)
+                        {
+                            cacheStore(key, 0, DNS_CACHE_NEGATIVE_TTL);
+                        }
+#endif
                     }
                 }
             }
@@ -233,7 +366,7 @@ uint16_t DNSClient::BuildRequest(const char* aName)
 }
 
 
-uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
+int16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress, uint32_t& aTtl)
 {
     uint32_t startTime = millis();
 
@@ -274,6 +407,13 @@ uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
     }
     // Check for any errors in the response (or in our request)
     // although we don't do anything to get round these
+    if ( !(header_flags & TRUNCATION_FLAG) &&
+        ((header_flags & RESP_MASK) == RESP_NAME_ERROR) )
+    {
+        // The name does not exist, worth remembering
+        iUdp.flush();
+        return NAME_ERROR;
+    }
     if ( (header_flags & TRUNCATION_FLAG) || (header_flags & RESP_MASK) )
     {
         // Mark the entire packet as read
@@ -302,18 +442,12 @@ uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
             {
                 // Don't need to actually read the data out for the string, just
                 // advance ptr to beyond it
-                while(len--)
-                {
-                    iUdp.read(); // we don't care about the returned byte
-                }
+                iUdp.skip(len);
             }
         } while (len != 0);
 
         // Now jump over the type and class
-        for (int i =0; i < 4; i++)
-        {
-            iUdp.read(); // we don't care about the returned byte
-        }
+        iUdp.skip(4);
     }
 
     // Now we're up to the bit we're interested in, the answer
@@ -336,10 +470,7 @@ uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
                     // And it's got a length
                     // Don't need to actually read the data out for the string,
                     // just advance ptr to beyond it
-                    while(len--)
-                    {
-                        iUdp.read(); // we don't care about the returned byte
-                    }
+                    iUdp.skip(len);
                 }
             }
             else
@@ -351,7 +482,7 @@ uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
                 // a pointer.  Either way, when we get here we're at the end of
                 // the name
                 // Skip over the pointer
-                iUdp.read(); // we don't care about the returned byte
+                iUdp.skip(1);
                 // And set len so that we drop out of the name loop
                 len = 0;
             }
@@ -363,11 +494,10 @@ uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
         iUdp.read((uint8_t*)&answerType, sizeof(answerType));
         iUdp.read((uint8_t*)&answerClass, sizeof(answerClass));
 
-        // Ignore the Time-To-Live as we don't do any caching
-        for (int i =0; i < TTL_SIZE; i++)
-        {
-            iUdp.read(); // we don't care about the returned byte
-        }
+        // Keep the Time-To-Live for the cache
+        uint8_t ttl[TTL_SIZE];
+        iUdp.read(ttl, TTL_SIZE);
+        aTtl = ((uint32_t)word(ttl[0], ttl[1]) << 16) | word(ttl[2], ttl[3]);
 
         // And read out the length of this answer
         // Don't need header_flags anymore, so we can reuse it here
@@ -388,10 +518,7 @@ uint16_t DNSClient::ProcessResponse(uint16_t aTimeout, IPAddress& aAddress)
         else
         {
             // This isn't an answer type we're after, move onto the next one
-            for (uint16_t i =0; i < htons(header_flags); i++)
-            {
-                iUdp.read(); // we don't care about the returned byte
-            }
+            iUdp.skip(htons(header_flags));
         }
     }
 
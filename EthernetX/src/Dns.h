@@ -7,6 +7,25 @@
 
 #include <EthernetUdp.h>
 
+// Number of host names whose answers are remembered between lookups.
+// The cache is shared by all DNSClient instances; 0 disables it.
+#ifndef DNS_CACHE_SIZE
+#define DNS_CACHE_SIZE 4
+#endif
+
+// Seconds to remember that a host name does not exist (NXDOMAIN)
+#ifndef DNS_CACHE_NEGATIVE_TTL
+#define DNS_CACHE_NEGATIVE_TTL 60
+#endif
+
+// Upper bound in seconds on the TTL honoured for a cached answer,
+// at most 65535 as cache entries keep the TTL in 16 bits
+#ifndef DNS_CACHE_MAX_TTL
+#define DNS_CACHE_MAX_TTL 3600
+#endif
+
+static_assert(DNS_CACHE_MAX_TTL <= 0xFFFF, "DNS_CACHE_MAX_TTL must fit in 16 bits");
+
 class DNSClient
 {
 public:
@@ -22,6 +41,8 @@ public:
     int inet_aton(const char *aIPAddrString, IPAddress& aResult);
 
     /** Resolve the given hostname to an IP address.
+        Answers are cached for their TTL (at most DNS_CACHE_MAX_TTL seconds),
+        and names that do not exist for DNS_CACHE_NEGATIVE_TTL seconds.
         @param aHostname Name to be resolved
         @param aResult IPAddress structure to store the returned IP address
         @result 1 if aIPAddrString was successfully converted to an IP address,
@@ -31,7 +52,7 @@ public:
 
 protected:
     uint16_t BuildRequest(const char* aName);
-    uint16_t ProcessResponse(uint16_t aTimeout, IPAddress& aAddress);
+    int16_t ProcessResponse(uint16_t aTimeout, IPAddress& aAddress, uint32_t& aTtl);
 
     IPAddress iDNSServer;
     uint16_t iRequestId;
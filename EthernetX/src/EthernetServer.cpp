@@ -11,6 +11,8 @@ extern "C" {
 EthernetServer::EthernetServer(uint16_t port)
 {
   _port = port;
+  _next = 0;
+  _idle = 0;
 }
 
 void EthernetServer::begin()
@@ -26,19 +28,26 @@ void EthernetServer::begin()
   }  
 }
 
-void EthernetServer::accept()
+void EthernetServer::accept(uint8_t *status, uint16_t *rxsize)
 {
   int listening = 0;
+  uint8_t mask = 0;
 
   for (int sock = 0; sock < MAX_SOCK_NUM; sock++) {
-    EthernetClient client(sock);
+    if (EthernetClass::_server_port[sock] == _port)
+      mask |= 1 << sock;
+  }
+  _idle = socketPoll(mask, _idle, status, rxsize);
 
-    if (EthernetClass::_server_port[sock] == _port) {
-      if (client.status() == SnSR::LISTEN) {
+  for (int sock = 0; sock < MAX_SOCK_NUM; sock++) {
+    if (mask & (1 << sock)) {
+      if (status[sock] == SnSR::LISTEN) {
         listening = 1;
       } 
-      else if (client.status() == SnSR::CLOSE_WAIT && !client.available()) {
+      else if (status[sock] == SnSR::CLOSE_WAIT && !rxsize[sock]) {
+        EthernetClient client(sock);
         client.stop();
+        status[sock] = SnSR::CLOSED;
       }
     } 
   }
@@ -50,18 +59,18 @@ void EthernetServer::accept()
 
 EthernetClient EthernetServer::available()
 {
-  accept();
+  uint8_t status[MAX_SOCK_NUM];
+  uint16_t rxsize[MAX_SOCK_NUM];
+  accept(status, rxsize);
 
-  for (int sock = 0; sock < MAX_SOCK_NUM; sock++) {
-    EthernetClient client(sock);
-    if (EthernetClass::_server_port[sock] == _port) {
-      uint8_t s = client.status();
-      if (s == SnSR::ESTABLISHED || s == SnSR::CLOSE_WAIT) {
-        if (client.available()) {
-          // XXX: don't always pick the lowest numbered socket.
-          return client;
-        }
-      }
+  // start after the socket returned last time, so that one busy client
+  // does not starve the others
+  for (int i = 0; i < MAX_SOCK_NUM; i++) {
+    uint8_t sock = (_next + i) % MAX_SOCK_NUM;
+    uint8_t s = status[sock];
+    if ((s == SnSR::ESTABLISHED || s == SnSR::CLOSE_WAIT) && rxsize[sock]) {
+      _next = (sock + 1) % MAX_SOCK_NUM;
+      return EthernetClient(sock);
     }
   }
 
@@ -76,14 +85,15 @@ size_t EthernetServer::write(uint8_t b)
 size_t EthernetServer::write(const uint8_t *buffer, size_t size) 
 {
   size_t n = 0;
+  uint8_t status[MAX_SOCK_NUM];
+  uint16_t rxsize[MAX_SOCK_NUM];
   
-  accept();
+  accept(status, rxsize);
 
   for (int sock = 0; sock < MAX_SOCK_NUM; sock++) {
     EthernetClient client(sock);
 
-    if (EthernetClass::_server_port[sock] == _port &&
-      client.status() == SnSR::ESTABLISHED) {
+    if (status[sock] == SnSR::ESTABLISHED) {
       n += client.write(buffer, size);
     }
   }
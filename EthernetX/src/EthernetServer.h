@@ -9,7 +9,9 @@ class EthernetServer :
 public Server {
 private:
   uint16_t _port;
-  void accept();
+  uint8_t _next; // socket to look at first for available()
+  uint8_t _idle; // sockets with nothing received when last polled
+  void accept(uint8_t *status, uint16_t *rxsize);
 public:
   EthernetServer(uint16_t);
   EthernetClient available();
@@ -118,47 +118,45 @@ size_t EthernetUDP::write(const uint8_t *buffer, size_t size)
 int EthernetUDP::parsePacket()
 {
   // discard any remaining bytes in the last packet
-  while (_remaining) {
-    // could this fail (loop endlessly) if _remaining > 0 and recv in read fails?
-    // should only occur if recv fails after telling us the data is there, lets
-    // hope the w5100 always behaves :)
-    read();
-  }
+  flush();
 
-  if (recvAvailable(_sock) > 0)
+  //HACK - hand-parse the UDP packet using TCP recv method
+  uint8_t tmpBuf[8];
+  //read 8 header bytes and get IP and port from it, the data stays in
+  //the chip and is read from _rxptr on
+  if (recvHeader(_sock, tmpBuf, 8, &_rxptr) > 0)
   {
-    //HACK - hand-parse the UDP packet using TCP recv method
-    uint8_t tmpBuf[8];
-    int ret =0; 
-    //read 8 header bytes and get IP and port from it
-    ret = recv(_sock,tmpBuf,8);
-    if (ret > 0)
-    {
-      _remoteIP = tmpBuf;
-      _remotePort = tmpBuf[4];
-      _remotePort = (_remotePort << 8) + tmpBuf[5];
-      _remaining = tmpBuf[6];
-      _remaining = (_remaining << 8) + tmpBuf[7];
-
-      // When we get here, any remaining bytes are the data
-      ret = _remaining;
-    }
-    return ret;
+    _remoteIP = tmpBuf;
+    _remotePort = tmpBuf[4];
+    _remotePort = (_remotePort << 8) + tmpBuf[5];
+    _remaining = tmpBuf[6];
+    _remaining = (_remaining << 8) + tmpBuf[7];
+
+    if (!_remaining)
+      recvDone(_sock, _rxptr);
+
+    // When we get here, any remaining bytes are the data
+    return _remaining;
   }
   // There aren't any packets available
   return 0;
 }
 
+// Moves on in the current packet, the chip is told only when it has been used up
+void EthernetUDP::advance(uint16_t len)
+{
+  _rxptr += len;
+  _remaining -= len;
+  if (!_remaining)
+    recvDone(_sock, _rxptr);
+}
+
 int EthernetUDP::read()
 {
   uint8_t byte;
 
-  if ((_remaining > 0) && (recv(_sock, &byte, 1) > 0))
-  {
-    // We read things without any problems
-    _remaining--;
+  if (read(&byte, 1) > 0)
     return byte;
-  }
 
   // If we get here, there's no data available
   return -1;
@@ -166,52 +164,41 @@ int EthernetUDP::read()
 
 int EthernetUDP::read(unsigned char* buffer, size_t len)
 {
-
   if (_remaining > 0)
   {
-
-    int got;
-
-    if (_remaining <= len)
-    {
-      // data should fit in the buffer
-      got = recv(_sock, buffer, _remaining);
-    }
-    else
-    {
-      // too much data for the buffer, 
-      // grab as much as will fit
-      got = recv(_sock, buffer, len);
-    }
-
-    if (got > 0)
-    {
-      _remaining -= got;
-      return got;
-    }
-
+    // grab as much as will fit
+    uint16_t got = _remaining <= len ? _remaining : len;
+    recvAt(_sock, _rxptr, buffer, got);
+    advance(got);
+    return got;
   }
 
-  // If we get here, there's no data available or recv failed
+  // If we get here, there's no data available
   return -1;
-
 }
 
 int EthernetUDP::peek()
 {
   uint8_t b;
-  // Unlike recv, peek doesn't check to see if there's any data available, so we must.
   // If the user hasn't called parsePacket yet then return nothing otherwise they
   // may get the UDP header
   if (!_remaining)
     return -1;
-  ::peek(_sock, &b);
+  recvAt(_sock, _rxptr, &b, 1);
   return b;
 }
 
+int EthernetUDP::skip(size_t len)
+{
+  uint16_t n = _remaining <= len ? _remaining : len;
+  if (n)
+    advance(n);
+  return n;
+}
+
 void EthernetUDP::flush()
 {
-  // TODO: we should wait for TX buffer to be emptied
+  skip(_remaining);
 }
 
 /* Start EthernetUDP socket, listening at local port PORT */
@@ -47,6 +47,9 @@ private:
   IPAddress _remoteIP; // remote IP address for the incoming packet whilst it's being processed
   uint16_t _remotePort; // remote port for the incoming packet whilst it's being processed
   uint16_t _offset; // offset into the packet being sent
+  uint16_t _rxptr; // chip RX buffer position of the next byte of the incoming packet
+
+  void advance(uint16_t len);
 
 protected:
   uint8_t _sock;  // socket ID for Wiz5100
@@ -91,6 +94,9 @@ public:
   virtual int read(char* buffer, size_t len) { return read((unsigned char*)buffer, len); };
   // Return the next byte from the current packet without moving on to the next byte
   virtual int peek();
+  // Skip up to len bytes of the current packet without reading them
+  // Returns the number of bytes skipped
+  int skip(size_t len);
   virtual void flush();	// Finish reading the current packet
 
   // Return the IP address of the host who sent the current incoming packet
@@ -219,6 +219,88 @@ int16_t recvAvailable(SOCKET s)
 }
 
 
+/**
+ * @brief	Starts reading a packet: copies its first len bytes (the header) to buf.
+ *
+ * Sn_RX_RD is left untouched; ptr is set just past the header, for recvAt and recvDone.
+ * @return	The received size, or 0 if there are fewer than len bytes.
+ */
+uint16_t recvHeader(SOCKET s, uint8_t *buf, uint16_t len, uint16_t *ptr)
+{
+  SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+  uint16_t ret = W5100.getRXReceivedSize(s);
+  if (ret >= len) {
+    *ptr = W5100.readSnRX_RD(s);
+    W5100.read_data(s, *ptr, buf, len);
+    *ptr += len;
+  } else {
+    ret = 0;
+  }
+  SPI.endTransaction();
+  return ret;
+}
+
+
+/**
+ * @brief	Copies len received bytes starting at ptr to buf, without consuming them
+ */
+void recvAt(SOCKET s, uint16_t ptr, uint8_t *buf, uint16_t len)
+{
+  SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+  W5100.read_data(s, ptr, buf, len);
+  SPI.endTransaction();
+}
+
+
+/**
+ * @brief	Releases the received data up to ptr, whether it was read or not
+ */
+void recvDone(SOCKET s, uint16_t ptr)
+{
+  SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+  W5100.writeSnRX_RD(s, ptr);
+  W5100.execCmdSn(s, Sock_RECV);
+  SPI.endTransaction();
+}
+
+
+/**
+ * @brief	Reads status and received size of the sockets in mask within one SPI transaction.
+ *
+ * A connected socket in idle (nothing received when last polled) is only asked for its
+ * received size when the interrupt register shows an event on it since then.
+ * Sockets outside of mask are reported as CLOSED with nothing received.
+ * @return	The sockets of mask that have nothing received, to pass as idle on the next call.
+ */
+uint8_t socketPoll(uint8_t mask, uint8_t idle, uint8_t *status, uint16_t *rxsize)
+{
+  uint8_t ret = 0;
+  SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+  uint8_t ir = W5100.readIR();
+  for (SOCKET s = 0; s < MAX_SOCK_NUM; s++) {
+    uint8_t bit = 1 << s;
+    status[s] = SnSR::CLOSED;
+    rxsize[s] = 0;
+    if (!(mask & bit))
+      continue;
+    status[s] = W5100.readSnSR(s);
+    if (status[s] == SnSR::ESTABLISHED || status[s] == SnSR::CLOSE_WAIT) {
+      if (ir & bit) {
+        // clear before reading the size, so that data arriving later raises it again
+        W5100.writeSnIR(s, SnIR::CON | SnIR::DISCON | SnIR::RECV);
+        rxsize[s] = W5100.getRXReceivedSize(s);
+      } else if (!(idle & bit)) {
+        rxsize[s] = W5100.getRXReceivedSize(s);
+      }
+    }
+    if (!rxsize[s])
+      ret |= bit;
+  }
+  SPI.endTransaction();
+  return ret;
+}
+
+
 /**
  * @brief	Returns the first byte in the receive queue (no checking)
  * 		
@@ -12,6 +12,10 @@ extern uint8_t listen(SOCKET s);	// Establish TCP connection (Passive connection
 extern uint16_t send(SOCKET s, const uint8_t * buf, uint16_t len); // Send data (TCP)
 extern int16_t recv(SOCKET s, uint8_t * buf, int16_t len);	// Receive data (TCP)
 extern int16_t recvAvailable(SOCKET s);
+extern uint16_t recvHeader(SOCKET s, uint8_t *buf, uint16_t len, uint16_t *ptr); // Read the start of a packet, leaving it in the buffer
+extern void recvAt(SOCKET s, uint16_t ptr, uint8_t *buf, uint16_t len); // Read at ptr, leaving the data in the buffer
+extern void recvDone(SOCKET s, uint16_t ptr); // Consume received data up to ptr
+extern uint8_t socketPoll(uint8_t mask, uint8_t idle, uint8_t *status, uint16_t *rxsize); // Status and received size of several sockets at once
 extern uint16_t peek(SOCKET s, uint8_t *buf);
 extern uint16_t sendto(SOCKET s, const uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t port); // Send data (UDP/IP RAW)
 extern uint16_t recvfrom(SOCKET s, uint8_t * buf, uint16_t len, uint8_t * addr, uint16_t *port); // Receive data (UDP/IP RAW)
@@ -154,24 +154,52 @@ uint8_t W5100Class::write(uint16_t _addr, uint8_t _data)
 
 uint16_t W5100Class::write(uint16_t _addr, const uint8_t *_buf, uint16_t _len)
 {
+#if !defined(SPI_HAS_EXTENDED_CS_PIN_HANDLING) && defined(ARDUINO_ARCH_AVR)
+  // W5100 has no SPI burst mode, so each byte still needs its own 4-byte frame.
+  // Drive SPDR directly and prepare the next frame byte while the current one
+  // is being shifted out.
   for (uint16_t i=0; i<_len; i++)
   {
-#if !defined(SPI_HAS_EXTENDED_CS_PIN_HANDLING)
-    setSS();    
-    SPI.transfer(0xF0);
-    SPI.transfer(_addr >> 8);
-    SPI.transfer(_addr & 0xFF);
+    uint8_t data = _buf[i];
+    setSS();
+    SPDR = 0xF0;
+    uint8_t hi = _addr >> 8;
+    uint8_t lo = _addr & 0xFF;
     _addr++;
-    SPI.transfer(_buf[i]);
+    while (!(SPSR & _BV(SPIF)));
+    SPDR = hi;
+    while (!(SPSR & _BV(SPIF)));
+    SPDR = lo;
+    while (!(SPSR & _BV(SPIF)));
+    SPDR = data;
+    while (!(SPSR & _BV(SPIF)));
     resetSS();
+  }
+#elif !defined(SPI_HAS_EXTENDED_CS_PIN_HANDLING)
+  uint8_t frame[4];
+  for (uint16_t i=0; i<_len; i++)
+  {
+    frame[0] = 0xF0;
+    frame[1] = _addr >> 8;
+    frame[2] = _addr & 0xFF;
+    frame[3] = _buf[i];
+    _addr++;
+    setSS();
+    SPI.transfer(frame, 4);
+    resetSS();
+  }
 #else
-    SPI.transfer(ETHERNET_SHIELD_SPI_CS, 0xF0, SPI_CONTINUE);
-    SPI.transfer(ETHERNET_SHIELD_SPI_CS, _addr >> 8, SPI_CONTINUE);
-    SPI.transfer(ETHERNET_SHIELD_SPI_CS, _addr & 0xFF, SPI_CONTINUE);
-    SPI.transfer(ETHERNET_SHIELD_SPI_CS, _buf[i]);
+  uint8_t frame[4];
+  for (uint16_t i=0; i<_len; i++)
+  {
+    frame[0] = 0xF0;
+    frame[1] = _addr >> 8;
+    frame[2] = _addr & 0xFF;
+    frame[3] = _buf[i];
     _addr++;
-#endif
+    SPI.transfer(ETHERNET_SHIELD_SPI_CS, frame, 4);
   }
+#endif
   return _len;
 }
 
@@ -195,24 +223,52 @@ uint8_t W5100Class::read(uint16_t _addr)
 
 uint16_t W5100Class::read(uint16_t _addr, uint8_t *_buf, uint16_t _len)
 {
+#if !defined(SPI_HAS_EXTENDED_CS_PIN_HANDLING) && defined(ARDUINO_ARCH_AVR)
+  // See write above: one frame per byte, with SPDR kept busy
   for (uint16_t i=0; i<_len; i++)
   {
-#if !defined(SPI_HAS_EXTENDED_CS_PIN_HANDLING)
     setSS();
-    SPI.transfer(0x0F);
-    SPI.transfer(_addr >> 8);
-    SPI.transfer(_addr & 0xFF);
+    SPDR = 0x0F;
+    uint8_t hi = _addr >> 8;
+    uint8_t lo = _addr & 0xFF;
+    _addr++;
+    while (!(SPSR & _BV(SPIF)));
+    SPDR = hi;
+    while (!(SPSR & _BV(SPIF)));
+    SPDR = lo;
+    while (!(SPSR & _BV(SPIF)));
+    SPDR = 0;
+    while (!(SPSR & _BV(SPIF)));
+    resetSS();
+    _buf[i] = SPDR;
+  }
+#elif !defined(SPI_HAS_EXTENDED_CS_PIN_HANDLING)
+  uint8_t frame[4];
+  for (uint16_t i=0; i<_len; i++)
+  {
+    frame[0] = 0x0F;
+    frame[1] = _addr >> 8;
+    frame[2] = _addr & 0xFF;
+    frame[3] = 0;
     _addr++;
-    _buf[i] = SPI.transfer(0);
+    setSS();
+    SPI.transfer(frame, 4);
     resetSS();
+    _buf[i] = frame[3];
+  }
 #else
-    SPI.transfer(ETHERNET_SHIELD_SPI_CS, 0x0F, SPI_CONTINUE);
-    SPI.transfer(ETHERNET_SHIELD_SPI_CS, _addr >> 8, SPI_CONTINUE);
-    SPI.transfer(ETHERNET_SHIELD_SPI_CS, _addr & 0xFF, SPI_CONTINUE);
-    _buf[i] = SPI.transfer(ETHERNET_SHIELD_SPI_CS, 0);
+  uint8_t frame[4];
+  for (uint16_t i=0; i<_len; i++)
+  {
+    frame[0] = 0x0F;
+    frame[1] = _addr >> 8;
+    frame[2] = _addr & 0xFF;
+    frame[3] = 0;
     _addr++;
-#endif
+    SPI.transfer(ETHERNET_SHIELD_SPI_CS, frame, 4);
+    _buf[i] = frame[3];
   }
+#endif
   return _len;
 }
 
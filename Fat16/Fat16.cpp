@@ -31,13 +31,17 @@ fat_t    Fat16::clusterCount_;               // total clusters in volume
 uint32_t Fat16::fatStartBlock_;              // start of first FAT
 uint32_t Fat16::rootDirStartBlock_;          // start of root dir
 uint32_t Fat16::dataStartBlock_;             // start of data clusters
+fat_t    Fat16::freeHint_;                   // clusters below are allocated
+#if FAT16_FREE_MAP
+uint8_t  Fat16::freeMap_[32];                // bit clear if FAT block is full
+#endif  // FAT16_FREE_MAP
 //------------------------------------------------------------------------------
 // raw block cache
 SdCard*   Fat16::rawDev_ = 0;             // class for block read and write
-uint32_t  Fat16::cacheBlockNumber_ = 0XFFFFFFFF;  // init to invalid block
-cache16_t Fat16::cacheBuffer_;            // 512 byte cache for SdCard
-bool      Fat16::cacheDirty_ = false;     // cacheFlush() write block if true
-uint32_t  Fat16::cacheMirrorBlock_ = 0;   // mirror  block for second FAT
+Fat16::cacheSlot_t Fat16::cacheSlot_[CACHE_SLOT_COUNT];  // all slots invalid
+Fat16::cacheSlot_t* Fat16::cacheCurrent_ = cacheSlot_;   // last used slot
+cache16_t* Fat16::cacheBuffer_ = &cacheSlot_[0].buf;     // last used buffer
+uint16_t  Fat16::cacheTick_ = 0;          // LRU access counter
 //------------------------------------------------------------------------------
 // callback function for date/time
 void (*Fat16::dateTime_)(uint16_t* date, uint16_t* time) = NULL;
@@ -74,18 +78,9 @@ static bool make83Name(const char* str, uint8_t* name) {
 // Fat16 member functions
 //------------------------------------------------------------------------------
 bool Fat16::addCluster(void) {
-  // start search after last cluster of file or at cluster two in FAT
-  fat_t freeCluster = curCluster_ ? curCluster_ : 1;
-  for (fat_t i = 0; ; i++) {
-    // return no free clusters
-    if (i >= clusterCount_) return false;
-    // Fat has clusterCount + 2 entries
-    if (freeCluster > clusterCount_) freeCluster = 1;
-    freeCluster++;
-    fat_t value;
-    if (!fatGet(freeCluster, &value)) return false;
-    if (value == 0) break;
-  }
+  // start search after last cluster of file or at the free hint
+  fat_t freeCluster;
+  if (!findFreeCluster(curCluster_ + 1, &freeCluster)) return false;
   // mark cluster allocated
   if (!fatPut(freeCluster, FAT16EOC)) return false;
 
@@ -105,38 +100,101 @@ bool Fat16::addCluster(void) {
 dir_t* Fat16::cacheDirEntry(uint16_t index, uint8_t action) {
   if (index >= rootDirEntryCount_) return NULL;
   if (!cacheRawBlock(rootDirStartBlock_ + (index >> 4), action)) return NULL;
-  return &cacheBuffer_.dir[index & 0XF];
+  return &cacheBuffer_->dir[index & 0XF];
+}
+//------------------------------------------------------------------------------
+// make blockNumber the current cache block using slots first to
+// first + count - 1, read it from the device if not already cached
+bool Fat16::cacheFetch(uint32_t blockNumber, uint8_t action,
+                       uint8_t first, uint8_t count) {
+  cacheSlot_t* slot = cacheCurrent_;
+  if (!slot->valid || slot->blockNumber != blockNumber) {
+    slot = cacheSelect(blockNumber, first, count);
+    if (!slot) return false;
+    if (!slot->valid) {
+      if (!rawDev_->readBlock(blockNumber, slot->buf.data)) return false;
+      slot->blockNumber = blockNumber;
+      slot->valid = true;
+    }
+    cacheCurrent_ = slot;
+    cacheBuffer_ = &slot->buf;
+  }
+  slot->lastUse = ++cacheTick_;
+  if (action) slot->dirty = true;
+  return true;
 }
 //------------------------------------------------------------------------------
 //
 bool Fat16::cacheFlush(void) {
-  if (cacheDirty_) {
-    if (!rawDev_->writeBlock(cacheBlockNumber_, cacheBuffer_.data)) {
+  for (uint8_t i = 0; i < CACHE_SLOT_COUNT; i++) {
+    if (!cacheFlushSlot(&cacheSlot_[i])) return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+//
+bool Fat16::cacheFlushSlot(cacheSlot_t* slot) {
+  if (slot->dirty) {
+    if (!rawDev_->writeBlock(slot->blockNumber, slot->buf.data)) {
       return false;
     }
     // mirror FAT tables
-    if (cacheMirrorBlock_) {
-      if (!rawDev_->writeBlock(cacheMirrorBlock_, cacheBuffer_.data)) {
+    if (slot->mirrorBlock) {
+      if (!rawDev_->writeBlock(slot->mirrorBlock, slot->buf.data)) {
         return false;
       }
-      cacheMirrorBlock_ = 0;
+      slot->mirrorBlock = 0;
     }
-    cacheDirty_ = false;
+    slot->dirty = false;
   }
   return true;
 }
 //------------------------------------------------------------------------------
-//
-bool Fat16::cacheRawBlock(uint32_t blockNumber, uint8_t action) {
-  if (cacheBlockNumber_ != blockNumber) {
-    if (!cacheFlush()) return false;
-    if (!rawDev_->readBlock(blockNumber, cacheBuffer_.data)) return false;
-    cacheBlockNumber_ = blockNumber;
+// drop cached copies of data blocks that are about to be overwritten
+void Fat16::cacheInvalidate(uint32_t blockNumber, uint8_t count) {
+  for (uint8_t i = 0; i < CACHE_DATA_COUNT; i++) {
+    cacheSlot_t* slot = &cacheSlot_[i];
+    if (slot->valid && (slot->blockNumber - blockNumber) < count) {
+      slot->valid = false;
+      slot->dirty = false;
+    }
   }
-  if (action) cacheDirty_ = true;
+}
+//------------------------------------------------------------------------------
+// make blockNumber the current data block without reading it from the
+// device, used when the whole block will be overwritten
+bool Fat16::cacheNewBlock(uint32_t blockNumber) {
+  cacheSlot_t* slot = cacheSelect(blockNumber, 0, CACHE_DATA_COUNT);
+  if (!slot) return false;
+  slot->blockNumber = blockNumber;
+  slot->valid = true;
+  slot->dirty = true;
+  slot->lastUse = ++cacheTick_;
+  cacheCurrent_ = slot;
+  cacheBuffer_ = &slot->buf;
   return true;
 }
 //------------------------------------------------------------------------------
+// return the slot that holds blockNumber or the least recently used slot
+// after writing it if dirty, the returned slot is invalid in the latter case
+Fat16::cacheSlot_t* Fat16::cacheSelect(uint32_t blockNumber,
+                                       uint8_t first, uint8_t count) {
+  cacheSlot_t* lru = 0;
+  uint16_t lruAge = 0;
+  for (cacheSlot_t* slot = cacheSlot_ + first;
+       slot < cacheSlot_ + first + count; slot++) {
+    if (slot->valid && slot->blockNumber == blockNumber) return slot;
+    uint16_t age = slot->valid ? cacheTick_ - slot->lastUse : 0XFFFF;
+    if (!lru || age > lruAge) {
+      lru = slot;
+      lruAge = age;
+    }
+  }
+  if (!cacheFlushSlot(lru)) return 0;
+  lru->valid = false;
+  return lru;
+}
+//------------------------------------------------------------------------------
 /**
  *  Close a file and force cached data and directory information
  *  to be written to the storage device.
@@ -167,13 +225,58 @@ bool Fat16::dirEntry(dir_t* dir) {
   return true;
 }
 //------------------------------------------------------------------------------
+// record that file cluster index is cluster if it directly follows the
+// clusters already covered by the extent cache
+void Fat16::extentAppend(fat_t index, fat_t cluster) {
+  if (index != extentClusters_) return;
+  if (extentCount_) {
+    extent_t* e = &extent_[extentCount_ - 1];
+    if (e->start + e->length == cluster) {
+      e->length++;
+      extentClusters_++;
+      return;
+    }
+  }
+  if (extentCount_ >= FAT16_EXTENT_CACHE_SIZE) return;
+  extent_[extentCount_].start = cluster;
+  extent_[extentCount_].length = 1;
+  extentCount_++;
+  extentClusters_++;
+}
+//------------------------------------------------------------------------------
+// find file cluster index in the extent cache
+bool Fat16::extentLookup(fat_t index, fat_t* cluster) const {
+  if (index >= extentClusters_) return false;
+  for (const extent_t* e = extent_; ; e++) {
+    if (index < e->length) {
+      *cluster = e->start + index;
+      return true;
+    }
+    index -= e->length;
+  }
+}
+//------------------------------------------------------------------------------
+// forget runs beyond the first count clusters of the file
+void Fat16::extentTrim(fat_t count) {
+  if (count >= extentClusters_) return;
+  extentClusters_ = 0;
+  for (uint8_t i = 0; i < extentCount_; i++) {
+    if (count <= extentClusters_) {
+      extentCount_ = i;
+      break;
+    }
+    if (extent_[i].length > count - extentClusters_) {
+      extent_[i].length = count - extentClusters_;
+    }
+    extentClusters_ += extent_[i].length;
+  }
+}
+//------------------------------------------------------------------------------
 bool Fat16::fatGet(fat_t cluster, fat_t* value) {
   if (cluster > (clusterCount_ + 1)) return false;
   uint32_t lba = fatStartBlock_ + (cluster >> 8);
-  if (lba != cacheBlockNumber_) {
-    if (!cacheRawBlock(lba)) return false;
-  }
-  *value = cacheBuffer_.fat[cluster & 0XFF];
+  if (!cacheFatBlock(lba)) return false;
+  *value = cacheBuffer_->fat[cluster & 0XFF];
   return true;
 }
 //------------------------------------------------------------------------------
@@ -181,16 +284,76 @@ bool Fat16::fatPut(fat_t cluster, fat_t value) {
   if (cluster < 2) return false;
   if (cluster > (clusterCount_ + 1)) return false;
   uint32_t lba = fatStartBlock_ + (cluster >> 8);
-  if (lba != cacheBlockNumber_) {
-    if (!cacheRawBlock(lba)) return false;
+  if (!cacheFatBlock(lba, CACHE_FOR_WRITE)) return false;
+  cacheBuffer_->fat[cluster & 0XFF] = value;
+  if (value == 0) {
+    // cluster is free
+    if (cluster < freeHint_) freeHint_ = cluster;
+#if FAT16_FREE_MAP
+    freeMap_[cluster >> 11] |= 1 << ((cluster >> 8) & 7);
+#endif  // FAT16_FREE_MAP
+  } else if (cluster == freeHint_) {
+    freeHint_++;
   }
-  cacheBuffer_.fat[cluster & 0XFF] = value;
-  cacheSetDirty();
   // mirror second FAT
-  if (fatCount_ > 1) cacheMirrorBlock_ = lba + blocksPerFat_;
+  if (fatCount_ > 1) cacheCurrent_->mirrorBlock = lba + blocksPerFat_;
   return true;
 }
 //------------------------------------------------------------------------------
+// find a free cluster, search FAT blocks from start and wrap around once
+bool Fat16::findFreeCluster(fat_t start, fat_t* cluster) {
+  fat_t last = clusterCount_ + 1;
+  if (start < freeHint_ || start > last) start = freeHint_;
+  uint16_t nBlock = (last >> 8) + 1;
+  uint16_t b = start >> 8;
+  for (uint16_t i = 0; i <= nBlock; i++, b = b + 1 < nBlock ? b + 1 : 0) {
+    fat_t end = (b << 8) | 0XFF;
+    // skip blocks below hint
+    if (end < freeHint_) continue;
+    if (end > last) end = last;
+#if FAT16_FREE_MAP
+    // skip blocks known to be full
+    if (!(freeMap_[b >> 3] & (1 << (b & 7)))) continue;
+#endif  // FAT16_FREE_MAP
+    fat_t c = i == 0 ? start : b << 8;
+    if (c < freeHint_) c = freeHint_;
+#if FAT16_FREE_MAP
+    // entries below the hint are allocated
+    bool wholeBlock = c == (b << 8) || c == freeHint_;
+#endif  // FAT16_FREE_MAP
+    for (;; c++) {
+      fat_t value;
+      if (!fatGet(c, &value)) return false;
+      if (value == 0) {
+        *cluster = c;
+        return true;
+      }
+      if (c == freeHint_) freeHint_++;
+      if (c == end) break;
+    }
+#if FAT16_FREE_MAP
+    if (wholeBlock) freeMap_[b >> 3] &= ~(1 << (b & 7));
+#endif  // FAT16_FREE_MAP
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+// find count contiguous free clusters at or after start
+bool Fat16::findFreeRun(fat_t start, fat_t count, fat_t* first) {
+  fat_t run = 0;
+  for (fat_t c = start; c <= clusterCount_ + 1; c++) {
+    fat_t value;
+    if (!fatGet(c, &value)) return false;
+    if (value) {
+      run = 0;
+    } else if (++run == count) {
+      *first = c - count + 1;
+      return true;
+    }
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
 /**
  * Get a string from a file.
  *
@@ -233,6 +396,39 @@ int16_t Fat16::fgets(char* str, int16_t num, char* delim) {
   return n;
 }
 //------------------------------------------------------------------------------
+// find cluster number of file cluster index, following the FAT chain from
+// the last cached run or the current cluster, whichever is closer
+bool Fat16::fileCluster(fat_t index, fat_t* cluster) {
+  if (extentLookup(index, cluster)) return true;
+  fat_t i;
+  fat_t c;
+  if (extentClusters_) {
+    i = extentClusters_ - 1;
+    extentLookup(i, &c);
+  } else {
+    i = 0;
+    c = firstCluster_;
+    if (c < 2) return false;
+    extentAppend(0, c);
+  }
+  // curCluster_ holds the byte before curPosition_
+  if (curPosition_ && curCluster_) {
+    fat_t k = clusterIndex(curPosition_ - 1);
+    if (k > i && k <= index) {
+      i = k;
+      c = curCluster_;
+    }
+  }
+  while (i < index) {
+    if (!fatGet(c, &c)) return false;
+    // return error if bad cluster chain
+    if (c < 2 || isEOC(c)) return false;
+    extentAppend(++i, c);
+  }
+  *cluster = c;
+  return true;
+}
+//------------------------------------------------------------------------------
 // free a cluster chain
 bool Fat16::freeChain(fat_t cluster) {
   while (1) {
@@ -270,13 +466,13 @@ bool Fat16::init(SdCard* dev, uint8_t part) {
   // if part > 0 assume mbr volume with partition table
   if (part) {
     if (!cacheRawBlock(volumeStartBlock)) return false;
-    volumeStartBlock = cacheBuffer_.mbr.part[part - 1].firstSector;
+    volumeStartBlock = cacheBuffer_->mbr.part[part - 1].firstSector;
   }
   if (!cacheRawBlock(volumeStartBlock)) return false;
   // check boot block signature
-  if (cacheBuffer_.data[510] != BOOTSIG0 ||
-      cacheBuffer_.data[511] != BOOTSIG1) return false;
-  fat_boot_t* bpb = &cacheBuffer_.fbs;
+  if (cacheBuffer_->data[510] != BOOTSIG0 ||
+      cacheBuffer_->data[511] != BOOTSIG1) return false;
+  fat_boot_t* bpb = &cacheBuffer_->fbs;
   fatCount_ = bpb->fatCount;
   blocksPerCluster_ = bpb->sectorsPerCluster;
   blocksPerFat_ = bpb->sectorsPerFat16;
@@ -303,6 +499,10 @@ bool Fat16::init(SdCard* dev, uint8_t part) {
     // not a usable FAT16 bpb
     return false;
   }
+  freeHint_ = 2;
+#if FAT16_FREE_MAP
+  memset(freeMap_, 0XFF, sizeof(freeMap_));
+#endif  // FAT16_FREE_MAP
   volumeInitialized_ = true;
   return true;
 }
@@ -476,12 +676,79 @@ bool Fat16::open(uint16_t index, uint8_t oflag) {
   dirEntryIndex_ = index;
   fileSize_ = d->fileSize;
   firstCluster_ = d->firstClusterLow;
+  extentCount_ = 0;
+  extentClusters_ = 0;
   flags_ = oflag & (O_ACCMODE | O_SYNC | O_APPEND);
 
   if (oflag & O_TRUNC ) return truncate(0);
   return true;
 }
 //------------------------------------------------------------------------------
+/**
+ * Allocate contiguous clusters so the file's cluster chain covers
+ * \a length bytes.  A data logger can call preAllocate() before timed
+ * sampling so later writes don't need to search the FAT for free clusters.
+ *
+ * The file size is not changed.  Clusters beyond the end of file remain
+ * allocated to the file until it is truncated.
+ *
+ * \param[in] length The number of bytes the file is expected to hold.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ * Reasons for failure include the file is not open for write,
+ * the volume has no run of free clusters large enough or an I/O error.
+ */
+bool Fat16::preAllocate(uint32_t length) {
+  // error if file is not open for write
+  if (!(flags_ & O_WRITE)) return false;
+  fat_t need = length ? clusterIndex(length - 1) + 1 : 0;
+
+  // find last cluster of chain which may extend beyond end of file
+  fat_t have = 0;
+  fat_t lastCluster = 0;
+  if (firstCluster_) {
+    have = fileSize_ ? clusterIndex(fileSize_ - 1) : 0;
+    if (!fileCluster(have, &lastCluster)) return false;
+    for (have++; ; have++) {
+      fat_t next;
+      if (!fatGet(lastCluster, &next)) return false;
+      if (isEOC(next)) break;
+      if (next < 2) return false;
+      lastCluster = next;
+    }
+  }
+  if (need <= have) return true;
+  fat_t count = need - have;
+
+  // prefer clusters that directly follow the chain
+  fat_t first = 0;
+  if (lastCluster && count <= clusterCount_ + 1 - lastCluster) {
+    fat_t i = 0;
+    for (; i < count; i++) {
+      fat_t value;
+      if (!fatGet(lastCluster + 1 + i, &value)) return false;
+      if (value) break;
+    }
+    if (i == count) first = lastCluster + 1;
+  }
+  if (!first && !findFreeRun(freeHint_, count, &first)) return false;
+  // link new clusters, mark last one end of chain
+  for (fat_t i = 0; i < count; i++) {
+    fat_t c = first + i;
+    if (!fatPut(c, i + 1 < count ? c + 1 : FAT16EOC)) return false;
+    extentAppend(have + i, c);
+  }
+  if (lastCluster) {
+    if (!fatPut(lastCluster, first)) return false;
+  } else {
+    // first cluster of file so update directory entry
+    firstCluster_ = first;
+    flags_ |= F_FILE_DIR_DIRTY;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
 /** %Print the name field of a directory entry in 8.3 format to Serial.
  *
  * \param[in] dir The directory structure containing the name.
@@ -591,28 +858,35 @@ int16_t Fat16::read(void* buf, uint16_t nbyte) {
     uint16_t blockOffset = cacheDataOffset(curPosition_);
     if (blkOfCluster == 0 && blockOffset == 0) {
       // start next cluster
-      if (curCluster_ == 0) {
-        curCluster_ = firstCluster_;
-      } else {
-        if (!fatGet(curCluster_, &curCluster_)) return -1;
-      }
-      // return error if bad cluster chain
-      if (curCluster_ < 2 || isEOC(curCluster_)) return -1;
+      if (!fileCluster(clusterIndex(curPosition_), &curCluster_)) return -1;
     }
-    // cache data block
-    if (!cacheRawBlock(dataBlockLba(curCluster_, blkOfCluster))) return -1;
+    uint32_t lba = dataBlockLba(curCluster_, blkOfCluster);
+    uint16_t n;
 
-    // location of data in cache
-    uint8_t* src = cacheBuffer_.data + blockOffset;
+    // whole blocks left in this cluster that the caller wants
+    uint8_t nb = blocksPerCluster_ - blkOfCluster;
+    if (nb > (nToRead >> 9)) nb = nToRead >> 9;
 
-    // max number of byte available in block
-    uint16_t n = 512 - blockOffset;
+    if (blockOffset == 0 && nb > 1) {
+      // stream blocks to caller bypassing the cache
+      if (!readBlocks(lba, dst, nb)) return -1;
+      n = (uint16_t)nb << 9;
+    } else {
+      // cache data block
+      if (!cacheRawBlock(lba)) return -1;
+
+      // location of data in cache
+      uint8_t* src = cacheBuffer_->data + blockOffset;
+
+      // max number of byte available in block
+      n = 512 - blockOffset;
 
-    // lesser of available and amount to read
-    if (n > nToRead) n = nToRead;
+      // lesser of available and amount to read
+      if (n > nToRead) n = nToRead;
 
-    // copy data to caller
-    memcpy(dst, src, n);
+      // copy data to caller
+      memcpy(dst, src, n);
+    }
 
     curPosition_ += n;
     dst += n;
@@ -621,6 +895,20 @@ int16_t Fat16::read(void* buf, uint16_t nbyte) {
   return nbyte;
 }
 //------------------------------------------------------------------------------
+// read contiguous data blocks directly into dst with a multiple block read
+bool Fat16::readBlocks(uint32_t blockNumber, uint8_t* dst, uint8_t count) {
+  // card must have current data since the cache is bypassed
+  if (!cacheFlush()) return false;
+  if (!rawDev_->readStart(blockNumber)) return false;
+  for (uint8_t i = 0; i < count; i++, dst += 512) {
+    if (!rawDev_->readData(dst)) {
+      rawDev_->readStop();
+      return false;
+    }
+  }
+  return rawDev_->readStop();
+}
+//------------------------------------------------------------------------------
 /**
  *  Read the next short, 8.3, directory entry.
  *
@@ -731,17 +1019,7 @@ bool Fat16::seekSet(uint32_t pos) {
     curPosition_ = 0;
     return true;
   }
-  fat_t n = ((pos - 1) >> 9)/blocksPerCluster_;
-  if (pos < curPosition_ || curPosition_ == 0) {
-    // must follow chain from first cluster
-    curCluster_ = firstCluster_;
-  } else {
-    // advance from curPosition
-    n -= ((curPosition_ - 1) >> 9)/blocksPerCluster_;
-  }
-  while (n--) {
-    if (!fatGet(curCluster_, &curCluster_)) return false;
-  }
+  if (!fileCluster(clusterIndex(pos - 1), &curCluster_)) return false;
   curPosition_ = pos;
   return true;
 }
@@ -858,13 +1136,14 @@ bool Fat16::truncate(uint32_t length) {
 
   if (length > fileSize_) return false;
 
-  // fileSize and length are zero - nothing to do
-  if (fileSize_ == 0) return true;
+  // fileSize and length are zero and no clusters preallocated - nothing to do
+  if (fileSize_ == 0 && firstCluster_ == 0) return true;
   uint32_t newPos = curPosition_ > length ? length : curPosition_;
   if (length == 0) {
     // free all clusters
     if (!freeChain(firstCluster_)) return false;
     curCluster_ = firstCluster_ = 0;
+    extentTrim(0);
   } else {
     fat_t toFree;
     if (!seekSet(length)) return false;
@@ -874,6 +1153,7 @@ bool Fat16::truncate(uint32_t length) {
       if (!fatPut(curCluster_, FAT16EOC)) return false;
       if (!freeChain(toFree)) return false;
     }
+    extentTrim(clusterIndex(length - 1) + 1);
   }
   fileSize_ = length;
   flags_ |= F_FILE_DIR_DIRTY;
@@ -913,49 +1193,145 @@ int16_t Fat16::write(const void* buf, uint16_t nbyte) {
     uint16_t blockOffset = cacheDataOffset(curPosition_);
     if (blkOfCluster == 0 && blockOffset == 0) {
       // start of new cluster
-      if (curCluster_ != 0) {
-        fat_t next;
-        if (!fatGet(curCluster_, &next)) goto writeErrorReturn;
-        if (isEOC(next)) {
-          // add cluster if at end of chain
-          if (!addCluster()) goto writeErrorReturn;
-        } else {
-          curCluster_ = next;
-        }
-      } else {
-        if (firstCluster_ == 0) {
-          // allocate first cluster of file
-          if (!addCluster()) goto writeErrorReturn;
-        } else {
-          curCluster_ = firstCluster_;
-        }
-      }
+      if (!writeCluster()) goto writeErrorReturn;
     }
     uint32_t lba = dataBlockLba(curCluster_, blkOfCluster);
-    if (blockOffset == 0 && curPosition_ >= fileSize_) {
-      // start of new block don't need to read into cache
-      if (!cacheFlush()) goto writeErrorReturn;
-      cacheBlockNumber_ = lba;
-      cacheSetDirty();
+    uint16_t n;
+
+    // whole blocks left in this cluster that the caller supplies
+    uint8_t nb = blocksPerCluster_ - blkOfCluster;
+    if (nb > (nToWrite >> 9)) nb = nToWrite >> 9;
+
+    if (blockOffset == 0 && nb > 1) {
+      // stream blocks to card bypassing the cache
+      if (!writeBlocks(lba, src, nb)) goto writeErrorReturn;
+      n = (uint16_t)nb << 9;
     } else {
-      // rewrite part of block
-      if (!cacheRawBlock(lba, CACHE_FOR_WRITE)) return -1;
-    }
-    uint8_t* dst = cacheBuffer_.data + blockOffset;
+      if (blockOffset == 0 && curPosition_ >= fileSize_) {
+        // start of new block don't need to read into cache
+        if (!cacheNewBlock(lba)) goto writeErrorReturn;
+      } else {
+        // rewrite part of block
+        if (!cacheRawBlock(lba, CACHE_FOR_WRITE)) return -1;
+      }
+      uint8_t* dst = cacheBuffer_->data + blockOffset;
 
-    // max space in block
-    uint16_t n = 512 - blockOffset;
+      // max space in block
+      n = 512 - blockOffset;
 
-    // lesser of space and amount to write
-    if (n > nToWrite) n = nToWrite;
+      // lesser of space and amount to write
+      if (n > nToWrite) n = nToWrite;
 
-    // copy data to cache
-    memcpy(dst, src, n);
+      // copy data to cache
+      memcpy(dst, src, n);
+    }
 
     curPosition_ += n;
     nToWrite -= n;
     src += n;
   }
+  if (!writeDone(nbyte)) goto writeErrorReturn;
+  return nbyte;
+
+ writeErrorReturn:
+  writeError = true;
+  return -1;
+}
+//------------------------------------------------------------------------------
+/**
+ * Get the part of the cached data block at the current file position so
+ * data can be formatted directly into it.  Follow with writeCommit().
+ *
+ * \param[out] size Number of bytes that can be placed in the buffer, up to
+ * the end of the block.
+ *
+ * \note No other Fat16 call may be made between writeBuffer() and
+ * writeCommit() as it could evict the block from the cache.
+ *
+ * \return Pointer into the cache for success or zero for failure.
+ * Use Fat16::writeError to check for errors.
+ */
+uint8_t* Fat16::writeBuffer(uint16_t* size) {
+  uint8_t blkOfCluster;
+  uint16_t blockOffset;
+  uint32_t lba;
+
+  // error if file is not open for write
+  if (!(flags_ & O_WRITE)) goto writeErrorReturn;
+
+  // go to end of file if O_APPEND
+  if ((flags_ & O_APPEND) && curPosition_ != fileSize_) {
+    if (!seekEnd()) goto writeErrorReturn;
+  }
+  blkOfCluster = blockOfCluster(curPosition_);
+  blockOffset = cacheDataOffset(curPosition_);
+  if (blkOfCluster == 0 && blockOffset == 0) {
+    // start of new cluster
+    if (!writeCluster()) goto writeErrorReturn;
+  }
+  lba = dataBlockLba(curCluster_, blkOfCluster);
+  if (blockOffset == 0 && curPosition_ >= fileSize_) {
+    // start of new block don't need to read into cache
+    if (!cacheNewBlock(lba)) goto writeErrorReturn;
+  } else {
+    // already the current block when filled by previous commits
+    if (!cacheRawBlock(lba, CACHE_FOR_WRITE)) goto writeErrorReturn;
+  }
+  *size = 512 - blockOffset;
+  return cacheBuffer_->data + blockOffset;
+
+ writeErrorReturn:
+  writeError = true;
+  return 0;
+}
+//------------------------------------------------------------------------------
+/**
+ * Advance the file position over data placed in the buffer returned by
+ * writeBuffer().
+ *
+ * \param[in] n Number of bytes placed, not more than the size returned
+ * by writeBuffer().
+ *
+ * \return true for success or false for failure.
+ */
+bool Fat16::writeCommit(uint16_t n) {
+  curPosition_ += n;
+  if (!writeDone(n)) {
+    writeError = true;
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+// make curCluster_ the cluster at curPosition_, that is at the start of
+// a cluster, adding a cluster at the end of the chain if needed
+bool Fat16::writeCluster(void) {
+  fat_t index = clusterIndex(curPosition_);
+  if (!extentLookup(index, &curCluster_)) {
+    if (curCluster_ != 0) {
+      fat_t next;
+      if (!fatGet(curCluster_, &next)) return false;
+      if (isEOC(next)) {
+        // add cluster if at end of chain
+        if (!addCluster()) return false;
+      } else {
+        curCluster_ = next;
+      }
+    } else {
+      if (firstCluster_ == 0) {
+        // allocate first cluster of file
+        if (!addCluster()) return false;
+      } else {
+        curCluster_ = firstCluster_;
+      }
+    }
+    extentAppend(index, curCluster_);
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+// update file size and directory state after nbyte were written
+bool Fat16::writeDone(uint16_t nbyte) {
   if (curPosition_ > fileSize_) {
     // update fileSize and insure sync will update dir entry
     fileSize_ = curPosition_;
@@ -966,13 +1342,25 @@ int16_t Fat16::write(const void* buf, uint16_t nbyte) {
   }
 
   if (flags_ & O_SYNC) {
-    if (!sync()) goto writeErrorReturn;
+    if (!sync()) return false;
   }
-  return nbyte;
-
- writeErrorReturn:
-  writeError = true;
-  return -1;
+  return true;
+}
+//------------------------------------------------------------------------------
+// write contiguous data blocks directly from src with a multiple block write
+bool Fat16::writeBlocks(uint32_t blockNumber,
+                        const uint8_t* src, uint8_t count) {
+  // all blocks are replaced so cached copies are stale
+  cacheInvalidate(blockNumber, count);
+  // no pre-erase, cards started with CMD1 may be MMC which has no ACMD23
+  if (!rawDev_->writeStart(blockNumber, 0)) return false;
+  for (uint8_t i = 0; i < count; i++, src += 512) {
+    if (!rawDev_->writeData(src)) {
+      rawDev_->writeStop();
+      return false;
+    }
+  }
+  return rawDev_->writeStop();
 }
 //------------------------------------------------------------------------------
 /**
@@ -151,6 +151,7 @@ class Fat16 : public Print {
   static void printFatDate(uint16_t fatDate);
   static void printFatTime(uint16_t fatTime);
   static void printTwoDigits(uint8_t v);
+  bool preAllocate(uint32_t length);
   int16_t read(void);
   int16_t read(void* buf, uint16_t nbyte);
   static bool readDir(dir_t* dir, uint16_t* index,
@@ -187,6 +188,8 @@ class Fat16 : public Print {
    */
   bool writeError;
   int16_t write(const void *buf, uint16_t nbyte);
+  uint8_t* writeBuffer(uint16_t* size);
+  bool writeCommit(uint16_t n);
   size_t write(uint8_t b);
   int16_t write(const char* str);
   void write_P(PGM_P str);
@@ -194,12 +197,12 @@ class Fat16 : public Print {
 //------------------------------------------------------------------------------
 #if FAT16_DEBUG_SUPPORT
   /** For debug only.  Do not use in applications. */
-  static cache16_t* dbgBufAdd(void) {return &cacheBuffer_;}
+  static cache16_t* dbgBufAdd(void) {return cacheBuffer_;}
   /** For debug only.  Do not use in applications. */
   static void dbgSetDev(SdCard* dev) {rawDev_ = dev;}
   /** For debug only.  Do not use in applications. */
   static uint8_t* dbgCacheBlock(uint32_t blockNumber) {
-    return cacheRawBlock(blockNumber) ? cacheBuffer_.data : 0; }
+    return cacheRawBlock(blockNumber) ? cacheBuffer_->data : 0; }
   /** For debug only.  Do not use in applications. */
   static dir_t* dbgCacheDir(uint16_t index) {
     return cacheDirEntry(index);}
@@ -217,15 +220,32 @@ class Fat16 : public Print {
   static uint32_t fatStartBlock_;      // start of first FAT
   static uint32_t rootDirStartBlock_;  // start of root dir
   static uint32_t dataStartBlock_;     // start of data clusters
+  static fat_t    freeHint_;           // clusters below are allocated
+#if FAT16_FREE_MAP
+  static uint8_t  freeMap_[32];        // bit clear if FAT block is full
+#endif  // FAT16_FREE_MAP
 
   // block cache
   static uint8_t const CACHE_FOR_READ  = 0;    // cache a block for read
   static uint8_t const CACHE_FOR_WRITE = 1;    // cache a block and set dirty
+  static uint8_t const CACHE_DATA_COUNT = FAT16_DATA_CACHE_BLOCKS;
+  static uint8_t const CACHE_FAT_COUNT  = FAT16_FAT_CACHE_BLOCKS;
+  static uint8_t const CACHE_SLOT_COUNT = CACHE_DATA_COUNT + CACHE_FAT_COUNT;
+  // first slot used for FAT blocks, data slots are shared if none reserved
+  static uint8_t const CACHE_FAT_FIRST  = CACHE_FAT_COUNT ? CACHE_DATA_COUNT : 0;
+  struct cacheSlot_t {
+    cache16_t buf;         // 512 byte cache for a raw block
+    uint32_t blockNumber;  // Logical number of block in the slot
+    uint32_t mirrorBlock;  // mirror block for second FAT
+    uint16_t lastUse;      // cacheTick_ at last access for LRU eviction
+    bool     valid;        // true if blockNumber is loaded in buf
+    bool     dirty;        // cacheFlush() will write block if true
+  };
   static SdCard *rawDev_;             // Device
-  static cache16_t cacheBuffer_;      // 512 byte cache for raw blocks
-  static uint32_t cacheBlockNumber_;  // Logical number of block in the cache
-  static bool    cacheDirty_;         // cacheFlush() will write block if true
-  static uint32_t cacheMirrorBlock_;  // mirror block for second FAT
+  static cacheSlot_t cacheSlot_[CACHE_SLOT_COUNT];  // cached blocks
+  static cacheSlot_t* cacheCurrent_;  // slot of the last cached block
+  static cache16_t* cacheBuffer_;     // buffer of the last cached block
+  static uint16_t cacheTick_;         // access counter for LRU eviction
 
   // callback function for date/time
   static void (*dateTime_)(uint16_t* date, uint16_t* time);
@@ -241,6 +261,15 @@ class Fat16 : public Print {
   fat_t curCluster_;       // current cluster
   uint32_t curPosition_;   // current byte offset
 
+  // contiguous runs of the file's cluster chain starting at its first cluster
+  struct extent_t {
+    fat_t start;   // first cluster of run
+    fat_t length;  // number of clusters in run
+  };
+  extent_t extent_[FAT16_EXTENT_CACHE_SIZE];
+  uint8_t extentCount_;    // number of runs in extent_
+  fat_t extentClusters_;   // number of file clusters covered by extent_
+
   // private functions for cache
   static uint8_t blockOfCluster(uint32_t position) {
     // depends on blocks per cluster being power of two
@@ -248,20 +277,48 @@ class Fat16 : public Print {
   }
   static uint16_t cacheDataOffset(uint32_t position) {return position & 0X1FF;}
   static dir_t* cacheDirEntry(uint16_t index, uint8_t action = 0);
-  static bool cacheFlush(void);  
-  static bool cacheRawBlock(uint32_t blockNumber, uint8_t action = 0);
-  static void cacheSetDirty(void) {cacheDirty_ = true;}
+  static bool cacheFatBlock(uint32_t blockNumber, uint8_t action = 0) {
+    return cacheFetch(blockNumber, action, CACHE_FAT_FIRST,
+                      CACHE_FAT_COUNT ? CACHE_FAT_COUNT : CACHE_DATA_COUNT);
+  }
+  static bool cacheFetch(uint32_t blockNumber, uint8_t action,
+                         uint8_t first, uint8_t count);
+  static bool cacheFlush(void);
+  static bool cacheFlushSlot(cacheSlot_t* slot);
+  static void cacheInvalidate(uint32_t blockNumber, uint8_t count);
+  static bool cacheNewBlock(uint32_t blockNumber);
+  static bool cacheRawBlock(uint32_t blockNumber, uint8_t action = 0) {
+    return cacheFetch(blockNumber, action, 0, CACHE_DATA_COUNT);
+  }
+  static void cacheSetDirty(void) {cacheCurrent_->dirty = true;}
+  static cacheSlot_t* cacheSelect(uint32_t blockNumber,
+                                  uint8_t first, uint8_t count);
   static uint32_t dataBlockLba(fat_t cluster, uint8_t blockOfCluster) {
     return dataStartBlock_ + (uint32_t)(cluster - 2) * blocksPerCluster_
       + blockOfCluster;
   }
   static bool fatGet(fat_t cluster, fat_t* value);
+  static bool readBlocks(uint32_t blockNumber, uint8_t* dst, uint8_t count);
+  static bool writeBlocks(uint32_t blockNumber,
+                          const uint8_t* src, uint8_t count);
   static bool fatPut(fat_t cluster, fat_t value);
+  static bool findFreeCluster(fat_t start, fat_t* cluster);
+  static bool findFreeRun(fat_t start, fat_t count, fat_t* first);
   // end of chain test
   static bool isEOC(fat_t cluster) {return cluster >= 0XFFF8;}
   // allocate a cluster to a file
   bool addCluster(void);
+  // index in the file of the cluster that holds byte position
+  static fat_t clusterIndex(uint32_t position) {
+    return (position >> 9)/blocksPerCluster_;
+  }
+  void extentAppend(fat_t index, fat_t cluster);
+  bool extentLookup(fat_t index, fat_t* cluster) const;
+  void extentTrim(fat_t count);
+  bool fileCluster(fat_t index, fat_t* cluster);
   // free a cluster chain
   bool freeChain(fat_t cluster);
+  bool writeCluster(void);
+  bool writeDone(uint16_t nbyte);
 };
 #endif  // Fat16_h
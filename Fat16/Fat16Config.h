@@ -33,4 +33,29 @@
  * Set non-zero to allow access to Fat16 internals by cardInfo debug sketch
  */
 #define FAT16_DEBUG_SUPPORT 1
+/**
+ * Number of 512 byte blocks cached for file data and directory entries.
+ * Must be at least one.  Each extra block costs 512 bytes of RAM.
+ * Least recently used blocks are evicted and dirty blocks are only
+ * written when evicted or by sync().
+ */
+#define FAT16_DATA_CACHE_BLOCKS 1
+/**
+ * Number of 512 byte blocks reserved for FAT entries.  Set non-zero so
+ * FAT lookups while walking or extending a cluster chain do not evict
+ * cached file data.  Zero shares the data cache for FAT access.
+ */
+#define FAT16_FAT_CACHE_BLOCKS 0
+/**
+ * Number of contiguous cluster runs of the FAT chain remembered by each
+ * open file.  Must be at least one.  Seeks and cluster advances inside
+ * remembered runs don't need FAT lookups.  Each run costs four bytes of
+ * RAM per Fat16 instance.
+ */
+#define FAT16_EXTENT_CACHE_SIZE 4
+/**
+ * Set non-zero to keep a 32 byte map of FAT blocks that are known to
+ * have no free entries so cluster allocation can skip them.
+ */
+#define FAT16_FREE_MAP 0
 #endif  // Fat16Config_h
@@ -0,0 +1,160 @@
+/* Arduino FAT16 Library
+ * Copyright (C) 2008 by William Greiman
+ *
+ * This file is part of the Arduino FAT16 Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino Fat16 Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <Arduino.h>
+#include <Fat16Writer.h>
+#include <FmtRef.h>
+//------------------------------------------------------------------------------
+Fat16Writer::Fat16Writer(Fat16* file)
+  : file_(file), pos_(0), avail_(0), used_(0), tmpl_(0),
+    syncRows_(0), syncMs_(0), unsynced_(0), syncTime_(millis()),
+    rowCount_(0), error_(false) {}
+//------------------------------------------------------------------------------
+/**
+ * Start a new row.
+ *
+ * \param[in] tmpl Optional FmtRef style template giving literal text and
+ * the width and format of numbers written with operator<<.  The template
+ * must stay valid until endRow().
+ */
+Fat16Writer& Fat16Writer::beginRow(const char* tmpl) {
+  tmpl_ = tmpl;
+  return *this;
+}
+//------------------------------------------------------------------------------
+/**
+ * Finish the row with the rest of the template and CR/LF, and sync
+ * if due.
+ *
+ * \return false if any write of the row failed.
+ */
+bool Fat16Writer::endRow(void) {
+  if (tmpl_) {
+    text(tmpl_);
+    tmpl_ = 0;
+  }
+  put("\r\n", 2);
+  if (!commit()) return false;
+  rowCount_++;
+  unsynced_++;
+  if ((syncRows_ && unsynced_ >= syncRows_) ||
+      (syncMs_ && millis() - syncTime_ >= syncMs_)) {
+    return sync();
+  }
+  return !error_;
+}
+//------------------------------------------------------------------------------
+/**
+ * Write rows placed so far and the directory entry to the card.
+ *
+ * \return true for success or false for failure.
+ */
+bool Fat16Writer::sync(void) {
+  commit();
+  if (!file_->sync()) error_ = true;
+  unsynced_ = 0;
+  syncTime_ = millis();
+  return !error_;
+}
+//------------------------------------------------------------------------------
+/** Write string \a str */
+Fat16Writer& Fat16Writer::text(const char* str) {
+  put(str, strlen(str));
+  return *this;
+}
+//------------------------------------------------------------------------------
+/** Write \a n chars from \a str */
+Fat16Writer& Fat16Writer::text(const char* str, uint16_t n) {
+  put(str, n);
+  return *this;
+}
+//------------------------------------------------------------------------------
+/** Format integer \a x as at most \a size chars */
+Fat16Writer& Fat16Writer::field(int32_t x, uint8_t size, fmt_t fmt) {
+  char* pos = fieldStart(&size);
+  if (pos) fieldEnd(pos, size, formatDecimal(x, pos, size, fmt), fmt);
+  return *this;
+}
+//------------------------------------------------------------------------------
+// advance file over bytes placed in the current block
+bool Fat16Writer::commit(void) {
+  if (used_ && !file_->writeCommit(used_)) error_ = true;
+  used_ = 0;
+  avail_ = 0;
+  return !error_;
+}
+//------------------------------------------------------------------------------
+// get the cache block at the current file position
+bool Fat16Writer::reserve(void) {
+  pos_ = file_->writeBuffer(&avail_);
+  used_ = 0;
+  if (!pos_) {
+    avail_ = 0;
+    error_ = true;
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+// copy n bytes, moving to the next block as blocks fill
+void Fat16Writer::put(const char* src, uint16_t n) {
+  while (n) {
+    if (!avail_ && !reserve()) return;
+    uint16_t k = n < avail_ ? n : avail_;
+    memcpy(pos_, src, k);
+    pos_ += k;
+    avail_ -= k;
+    used_ += k;
+    src += k;
+    n -= k;
+    if (!avail_) commit();
+  }
+}
+//------------------------------------------------------------------------------
+// return where to format a field of size chars, in the block if it fits,
+// size is limited to FAT16_WRITER_FIELD_MAX wherever the field lands
+char* Fat16Writer::fieldStart(uint8_t* size) {
+  if (*size > FAT16_WRITER_FIELD_MAX) *size = FAT16_WRITER_FIELD_MAX;
+  if (!avail_ && !reserve()) return 0;
+  if (*size <= avail_) return reinterpret_cast<char*>(pos_);
+  return field_;
+}
+//------------------------------------------------------------------------------
+// account for a formatted field, right aligned fields keep their width
+void Fat16Writer::fieldEnd(char* pos, uint8_t size, uint8_t actual,
+                           fmt_t fmt) {
+  uint8_t n = (fmt & FMT_RIGHT) ? size : actual;
+  if (pos == field_) {
+    put(field_, n);
+  } else {
+    pos_ += n;
+    avail_ -= n;
+    used_ += n;
+    if (!avail_) commit();
+  }
+}
+//------------------------------------------------------------------------------
+// write template text up to its next number and skip over the number
+bool Fat16Writer::nextTemplate(uint8_t* size, fmt_t* fmt) {
+  if (!tmpl_) return false;
+  const char* start = FmtRef::parse(tmpl_, size, fmt);
+  put(tmpl_, start - tmpl_);
+  tmpl_ = start + *size;
+  return *size != 0;
+}
@@ -0,0 +1,141 @@
+/* Arduino FAT16 Library
+ * Copyright (C) 2008 by William Greiman
+ *
+ * This file is part of the Arduino FAT16 Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino Fat16 Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef Fat16Writer_h
+#define Fat16Writer_h
+/**
+ * \file
+ * Fat16Writer class
+ */
+#include <Fat16.h>
+#include <FixNum.h>
+//------------------------------------------------------------------------------
+/** Largest single field formatted by Fat16Writer */
+#define FAT16_WRITER_FIELD_MAX 24
+//------------------------------------------------------------------------------
+/** \class Fat16Writer
+ * \brief Fat16Writer formats CSV/log rows directly into the cache block
+ *
+ * Each row takes one Fat16::writeBuffer() call and one Fat16::writeCommit()
+ * call per block it touches, so fields are not copied through temporary
+ * buffers and Fat16::write().  A field that does not fit in the rest of the
+ * block is formatted into a small buffer and split across the two blocks.
+ *
+ * Fields are either free form:
+ * \code
+ * log.beginRow();
+ * log.dateTime(now).text(",").field(temp, 6).text(",").field(count, 5);
+ * log.endRow();
+ * \endcode
+ *
+ * or take width and format from a FmtRef style template:
+ * \code
+ * log.beginRow(",+??.?,????");
+ * log.dateTime(now) << temp << count;
+ * log.endRow();
+ * \endcode
+ *
+ * Literal text of the template is written before each number and by
+ * endRow().  Free form numbers are left aligned and trimmed unless
+ * FMT_RIGHT is used, template numbers always take their full width.
+ * A field is never wider than FAT16_WRITER_FIELD_MAX chars.
+ *
+ * The file is synced after a number of rows or milliseconds set with
+ * syncEvery(), not after every row.
+ */
+class Fat16Writer {
+ public:
+  /** create writer for an open file */
+  explicit Fat16Writer(Fat16* file);
+  /**
+   * Set sync cadence, zero disables a condition.
+   *
+   * \param[in] rows Sync after this many rows.
+   * \param[in] ms Sync when this many milliseconds passed since last sync.
+   */
+  void syncEvery(uint16_t rows, uint32_t ms = 0) {
+    syncRows_ = rows;
+    syncMs_ = ms;
+  }
+  Fat16Writer& beginRow(const char* tmpl = 0);
+  bool endRow(void);
+  bool sync(void);
+
+  Fat16Writer& text(const char* str);
+  Fat16Writer& text(const char* str, uint16_t n);
+  Fat16Writer& field(int32_t x, uint8_t size, fmt_t fmt = FMT_NONE);
+  /** Format FixNum \a x as at most \a size chars */
+  template<typename T, prec_t prec>
+  Fat16Writer& field(FixNum<T, prec> x, uint8_t size, fmt_t fmt = (fmt_t)prec) {
+    char* pos = fieldStart(&size);
+    if (pos) fieldEnd(pos, size, x.format(pos, size, fmt), fmt);
+    return *this;
+  }
+  /** Format date/time \a dt as YY-MM-DD HH:MM:SS, see DateTime::format() */
+  template<class D> Fat16Writer& dateTime(const D& dt) {
+    uint8_t size = sizeof(typename D::str_t) - 1;
+    char* pos = fieldStart(&size);
+    if (pos) {
+      dt.format(pos);
+      fieldEnd(pos, size, size, FMT_RIGHT);
+    }
+    return *this;
+  }
+  /** Format FixNum \a x as the next number of the row template */
+  template<typename T, prec_t prec>
+  Fat16Writer& operator<<(FixNum<T, prec> x) {
+    uint8_t size;
+    fmt_t fmt;
+    if (nextTemplate(&size, &fmt)) field(x, size, fmt | FMT_RIGHT);
+    return *this;
+  }
+  /** Format integer \a x as the next number of the row template */
+  Fat16Writer& operator<<(int32_t x) {
+    uint8_t size;
+    fmt_t fmt;
+    if (nextTemplate(&size, &fmt)) field(x, size, fmt | FMT_RIGHT);
+    return *this;
+  }
+  /** \return true if a write failed since the writer was created */
+  bool writeError(void) const {return error_;}
+  /** \return Rows written since the writer was created */
+  uint32_t rowCount(void) const {return rowCount_;}
+
+ private:
+  Fat16* file_;
+  uint8_t* pos_;         // next free byte in the cache block
+  uint16_t avail_;       // free bytes left in the cache block
+  uint16_t used_;        // bytes placed in the block not yet committed
+  const char* tmpl_;     // rest of the row template
+  uint16_t syncRows_;
+  uint32_t syncMs_;
+  uint16_t unsynced_;    // rows since last sync
+  uint32_t syncTime_;    // millis() of last sync
+  uint32_t rowCount_;
+  bool error_;
+  char field_[FAT16_WRITER_FIELD_MAX];  // field straddling a block end
+
+  bool commit(void);
+  bool reserve(void);
+  void put(const char* src, uint16_t n);
+  char* fieldStart(uint8_t* size);
+  void fieldEnd(char* pos, uint8_t size, uint8_t actual, fmt_t fmt);
+  bool nextTemplate(uint8_t* size, fmt_t* fmt);
+};
+#endif  // Fat16Writer_h
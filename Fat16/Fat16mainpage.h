@@ -109,6 +109,15 @@ directory information.  This includes writing the current data block, reading
 the block that contains the directory entry for update, writing the directory
 block back and reading back the current data block.
 
+\par
+Loggers that write rows of numbers can use Fat16Writer instead of
+\link Print::print() print()\endlink.  It formats FixNum, integer and
+DateTime fields straight into the cache block, using
+\link Fat16::writeBuffer() writeBuffer() \endlink and
+\link Fat16::writeCommit() writeCommit() \endlink, and calls
+\link Fat16::sync() sync() \endlink after a configurable number of rows
+or milliseconds.  Fat16Writer needs the FixNum library.
+
 Fat16 only supports access to files in the root directory and only supports
 short 8.3 names.
 
@@ -134,6 +143,9 @@ highest priority goal followed by flash use and finally performance.
 Most SD cards only support 512 byte block write operations so a 512 byte
 cache buffer is used by Fat16.  This is the main use of RAM.  A small
 amount of RAM is used to store key volume and file information.
+Boards with more RAM can cache extra data blocks and reserve blocks for
+FAT entries with FAT16_DATA_CACHE_BLOCKS and FAT16_FAT_CACHE_BLOCKS
+in Fat16Config.h.
 Flash memory usage can be controlled by selecting options in Fat16Config.h.
 
 \section HowTo How to format SD Cards as FAT16 Volumes
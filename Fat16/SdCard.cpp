@@ -210,6 +210,71 @@ bool SdCard::readBlock(uint32_t blockNumber, uint8_t* dst) {
   return readTransfer(dst, 512);
 }
 //------------------------------------------------------------------------------
+/**
+ * Read one data block in a multiple block read sequence.
+ *
+ * \param[out] dst Pointer to the location for the 512 byte data block.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdCard::readData(uint8_t* dst) {
+  chipSelectLow();
+  return readTransfer(dst, 512);
+}
+//------------------------------------------------------------------------------
+/**
+ * Start a read multiple blocks sequence with CMD18.
+ *
+ * Call readData() for each block then readStop() to end the sequence.
+ * No other card operation is allowed until readStop() is called.
+ *
+ * \param[in] blockNumber Address of first block in sequence.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdCard::readStart(uint32_t blockNumber) {
+  if (cardCommand(CMD18, blockNumber << 9)) {
+    error(SD_ERROR_CMD18);
+    return false;
+  }
+  chipSelectHigh();
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * End a read multiple blocks sequence.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdCard::readStop(void) {
+  uint8_t r1;
+
+  // no wait for not busy, the card is still sending data
+  chipSelectLow();
+  spiSend(CMD12 | 0x40);
+  for (int8_t s = 24; s >= 0; s -= 8) spiSend(0);
+  spiSend(0XFF);
+
+  // discard stuff byte, it may be the rest of the aborted block
+  spiRec();
+
+  for (uint8_t retry = 0; (0X80 & (r1 = spiRec())) && retry != 0XFF; retry++);
+  if (r1) {
+    error(SD_ERROR_CMD12, r1);
+    return false;
+  }
+  // R1b response, wait for busy to clear
+  if (!waitForToken(0XFF, SD_WRITE_TIMEOUT)) {
+    error(SD_ERROR_CMD12);
+    return false;
+  }
+  chipSelectHigh();
+  return true;
+}
+//------------------------------------------------------------------------------
 bool SdCard::readReg(uint8_t cmd, void* buf) {
   uint8_t* dst = reinterpret_cast<uint8_t*>(buf);
   if (cardCommand(cmd, 0)) {
@@ -253,8 +318,91 @@ bool SdCard::writeBlock(uint32_t blockNumber, const uint8_t* src) {
     error(SD_ERROR_CMD24);
     return false;
   }
+  if (!writeTransfer(DATA_START_BLOCK, src)) return false;
+
+  // wait for card to complete write programming
+  if (!waitForToken(0XFF, SD_WRITE_TIMEOUT)) {
+      error(SD_ERROR_WRITE_TIMEOUT);
+  }
+  chipSelectHigh();
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Write one data block in a multiple block write sequence.
+ *
+ * \param[in] src Pointer to the location of the 512 byte data block.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdCard::writeData(const uint8_t* src) {
+  chipSelectLow();
+  // wait for previous block to be programmed
+  if (!waitForToken(0XFF, SD_WRITE_TIMEOUT)) {
+    error(SD_ERROR_WRITE_TIMEOUT);
+    return false;
+  }
+  if (!writeTransfer(WRITE_MULTIPLE_TOKEN, src)) return false;
+  chipSelectHigh();
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Start a write multiple blocks sequence with CMD25.
+ *
+ * Call writeData() for each block then writeStop() to end the sequence.
+ * No other card operation is allowed until writeStop() is called.
+ *
+ * \param[in] blockNumber Address of first block in sequence.
+ *
+ * \param[in] eraseCount The number of blocks to be pre-erased with ACMD23.
+ * Pre-erase speeds up the sequence but the content of blocks that are
+ * pre-erased and not written is undefined.  Zero skips pre-erase.
+ * ACMD23 is an SD command, use zero for MMC cards.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdCard::writeStart(uint32_t blockNumber, uint32_t eraseCount) {
+  if (eraseCount && cardAcmd(ACMD23, eraseCount)) {
+    error(SD_ERROR_ACMD23);
+    return false;
+  }
+  if (cardCommand(CMD25, blockNumber << 9)) {
+    error(SD_ERROR_CMD25);
+    return false;
+  }
+  chipSelectHigh();
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * End a write multiple blocks sequence.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdCard::writeStop(void) {
+  chipSelectLow();
+  if (!waitForToken(0XFF, SD_WRITE_TIMEOUT)) {
+    error(SD_ERROR_STOP_TRAN);
+    return false;
+  }
+  spiSend(STOP_TRAN_TOKEN);
+  // wait for card to complete write programming
+  if (!waitForToken(0XFF, SD_WRITE_TIMEOUT)) {
+    error(SD_ERROR_STOP_TRAN);
+    return false;
+  }
+  chipSelectHigh();
+  return true;
+}
+//------------------------------------------------------------------------------
+// send token and data block, chip select must be low
+bool SdCard::writeTransfer(uint8_t token, const uint8_t* src) {
   // optimize write loop
-  SPDR = DATA_START_BLOCK;
+  SPDR = token;
   for (uint16_t i = 0; i < 512; i++) {
     while (!(SPSR & (1 << SPIF)));
     SPDR = src[i];
@@ -269,10 +417,5 @@ bool SdCard::writeBlock(uint32_t blockNumber, const uint8_t* src) {
     error(SD_ERROR_WRITE_RESPONSE, r1);
     return false;
   }
-  // wait for card to complete write programming
-  if (!waitForToken(0XFF, SD_WRITE_TIMEOUT)) {
-      error(SD_ERROR_WRITE_TIMEOUT);
-  }
-  chipSelectHigh();
   return true;
 }
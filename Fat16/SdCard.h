@@ -47,6 +47,16 @@ uint8_t const SD_ERROR_BLOCK_ZERO_WRITE  = 0X8;
 uint8_t const SD_ERROR_WRITE_PROGRAMMING = 0X9;
 /** card fialed to initialize with CMD1*/
 uint8_t const SD_ERROR_CMD1              = 0XA;
+/** Read multiple blocks command not accepted */
+uint8_t const SD_ERROR_CMD18             = 0XB;
+/** Write multiple blocks command not accepted */
+uint8_t const SD_ERROR_CMD25             = 0XC;
+/** Set pre-erase count command not accepted */
+uint8_t const SD_ERROR_ACMD23            = 0XD;
+/** Stop transmission command not accepted */
+uint8_t const SD_ERROR_CMD12             = 0XE;
+/** timeout waiting for card to accept stop token after multiple block write */
+uint8_t const SD_ERROR_STOP_TRAN         = 0XF;
 //------------------------------------------------------------------------------
 /**
  * \class SdCard
@@ -94,6 +104,9 @@ class SdCard  {
   bool init(bool halfSpeed, uint8_t chipSelect) {
     return begin(halfSpeed ? SPI_HALF_SPEED : SPI_FULL_SPEED, chipSelect);}
   bool readBlock(uint32_t block, uint8_t* dst);
+  bool readData(uint8_t* dst);
+  bool readStart(uint32_t blockNumber);
+  bool readStop(void);
   /** 
    * Read the CID register which contains info about the card.
    * This includes Manufacturer ID, OEM ID, product name, version,
@@ -108,6 +121,9 @@ class SdCard  {
     return readReg(CMD10, cid);
   }
   bool writeBlock(uint32_t block, const uint8_t* src);
+  bool writeData(const uint8_t* src);
+  bool writeStart(uint32_t blockNumber, uint32_t eraseCount);
+  bool writeStop(void);
  private:
   uint8_t cardAcmd(uint8_t cmd, uint32_t arg);
   uint8_t cardCommand(uint8_t cmd, uint32_t arg);
@@ -119,5 +135,6 @@ class SdCard  {
   void error(uint8_t code);
   bool readReg(uint8_t cmd, void* buf);
   bool readTransfer(uint8_t* dst, uint16_t count);
+  bool writeTransfer(uint8_t token, const uint8_t* src);
 };
 #endif  // SdCard_h
@@ -0,0 +1,63 @@
+// Logs analog pins as fixed width CSV rows with Fat16Writer
+#define CHIP_SELECT     SS // SD chip select pin
+#define LOG_INTERVAL   100 // mills between entries
+#define SYNC_ROWS      100 // rows between calls to sync()
+#define SYNC_INTERVAL 5000 // or mills between calls to sync()
+
+#include <Fat16.h>
+#include <Fat16Writer.h>
+#include <Fat16util.h> // use functions to print strings from flash memory
+
+SdCard card;
+Fat16 file;
+Fat16Writer writer(&file);
+uint32_t logTime = 0;     // time data was logged
+
+// millis, then pin 0 in volts and pins 1, 2 as raw readings
+const char ROW[] = "?????????,?.???,????,????";
+
+// store error strings in flash to save RAM
+#define error(s) error_P(PSTR(s))
+//------------------------------------------------------------------------------
+void error_P(const char* str) {
+  PgmPrint("error: ");
+  SerialPrintln_P(str);
+  if (card.errorCode) {
+    PgmPrint("SD error: ");
+    Serial.println(card.errorCode, HEX);
+  }
+  while(1);
+}
+//------------------------------------------------------------------------------
+void setup(void) {
+  Serial.begin(9600);
+
+  if (!card.begin(CHIP_SELECT)) error("card.begin");
+  if (!Fat16::init(&card)) error("Fat16::init");
+
+  char name[] = "ROWLOG00.CSV";
+  for (uint8_t i = 0; i < 100; i++) {
+    name[6] = i/10 + '0';
+    name[7] = i%10 + '0';
+    if (file.open(name, O_CREAT | O_EXCL | O_WRITE)) break;
+  }
+  if (!file.isOpen()) error ("create");
+  PgmPrint("Logging to: ");
+  Serial.println(name);
+
+  writer.syncEvery(SYNC_ROWS, SYNC_INTERVAL);
+  writer.beginRow().text("millis,volt0,sens1,sens2");
+  if (!writer.endRow() || !writer.sync()) error("write header");
+}
+//------------------------------------------------------------------------------
+void loop() {
+  if (millis() - logTime < LOG_INTERVAL) return;
+  logTime += LOG_INTERVAL;
+
+  // 0..1023 scaled to 0.000..5.000 volts
+  fixnum32_3 volt0 = fixnum32_3((int32_t)analogRead(0) * 5000 / 1023);
+
+  writer.beginRow(ROW);
+  writer << (int32_t)logTime << volt0 << (int32_t)analogRead(1) << (int32_t)analogRead(2);
+  if (!writer.endRow()) error("write data");
+}
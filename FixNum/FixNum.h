@@ -26,6 +26,8 @@ private:
 
   static const T INVALID = FixNumUtil::Limits<T>::maxValue;
 public:
+  typedef T mantissa_t;
+
   // constants
   static const T multiplier = FixNumUtil::Multiplier<prec>::multiplier;
 
@@ -97,6 +99,10 @@ typedef FixNum<int32_t,4> fixnum32_4;
 typedef FixNum<int32_t,5> fixnum32_5;
 typedef FixNum<int32_t,6> fixnum32_6;
 
+// Formats count values into fixed-width cells of size chars placed every stride chars
+// (like rows of a text block), for refreshing a whole column of a display or table at once
+template<typename T, prec_t prec> void formatColumn(const FixNum<T, prec>* values, uint8_t count, char* pos, uint8_t size, uint8_t stride, fmt_t fmt = (fmt_t)prec);
+
 // Parser for FixNum
 template<typename T> class FixNumParser {
 private:
@@ -158,6 +164,13 @@ template<typename T, prec_t prec> template<typename T2, prec_t prec2> inline Fix
   return FixNum<T2, prec2>(FixNumUtil::convert<T, T2>(_mantissa, prec, prec2));
 }
 
+// ----------- formatColumn implementation -----------
+
+template<typename T, prec_t prec> void formatColumn(const FixNum<T, prec>* values, uint8_t count, char* pos, uint8_t size, uint8_t stride, fmt_t fmt) {
+  for (uint8_t i = 0; i < count; i++, pos += stride)
+    values[i].format(pos, size, fmt);
+}
+
 // ----------- class FixNumParser implementation -----------
 
 template<typename T> inline void FixNumParser<T>::reset() {
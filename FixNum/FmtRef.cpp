@@ -9,7 +9,7 @@ char* FmtRef::find(char* pos, char tag) {
   } 
 }
 
-void FmtRef::init(char* pos) {
+const char* FmtRef::parse(const char* pos, uint8_t* size, fmt_t* fmt) {
   char c;
   while (true) {
     c = *pos;
@@ -17,30 +17,36 @@ void FmtRef::init(char* pos) {
       break;
     pos++;
   }
-  _pos = pos;
-  _size = 0;
-  _fmt = 0;
+  const char* start = pos;
+  uint8_t s = 0;
+  fmt_t f = 0;
   bool dot = false;
   if (c == '+' || c == '-') {
-    _fmt |= FMT_SIGN;
-    _size++;
+    f |= FMT_SIGN;
+    s++;
     c = *(++pos);
   }
   if (c == '0') 
-    _fmt |= FMT_ZERO;
+    f |= FMT_ZERO;
   if (c == '9')
-    _fmt |= FMT_RIGHT;
+    f |= FMT_RIGHT;
   while (c != 0) {
     if (c == '.' && !dot)
       dot = true;
     else if (c == '?' || (c >= '0' && c <= '9')) {
       // ok - go next char
       if (dot)
-        _fmt++;
+        f++;
     } else
       break; // done
-    _size++;
+    s++;
     c = *(++pos);
   }
+  *size = s;
+  *fmt = f;
+  return start;
 }
 
+void FmtRef::init(char* pos) {
+  _pos = (char*)parse(pos, &_size, &_fmt);
+}
@@ -19,6 +19,9 @@ public:
 
   static char* find(char* pos, char tag);
 
+  // finds next number template starting from pos, returns its start and stores its size and format
+  static const char* parse(const char* pos, uint8_t* size, fmt_t* fmt);
+
 private:
   char* _pos;
   uint8_t _size;    
@@ -1,4 +1,62 @@
 #include "FmtUtil.h"
+#include "utility/FixNumUtil.h"
+#include <avr/pgmspace.h>
+
+// Largest value for which div100 below is exact
+const uint16_t DIV100_MAX = 43698;
+
+static_assert(FixNumUtil::Limits<int16_t>::maxValue <= DIV100_MAX, "int16_t magnitude must be divisible by multiply and shift");
+
+// "00" to "99" to emit two digits per step
+static const char DIGIT_PAIRS[201] PROGMEM =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// Division by 100 with a multiply and shift, exact for x <= DIV100_MAX
+static inline uint16_t div100(uint16_t x) {
+  return (uint16_t)(((uint32_t)x * 5243) >> 19);
+}
+
+// Stores two digits of r < 100 least significant first
+static inline void putPair(char* dig, uint8_t r) {
+  dig[0] = pgm_read_byte(&DIGIT_PAIRS[2 * r + 1]);
+  dig[1] = pgm_read_byte(&DIGIT_PAIRS[2 * r]);
+}
+
+// Stores digits of x least significant first, returns their count (none for zero)
+static uint8_t digits(uint16_t x, char* dig) {
+  uint8_t n = 0;
+  while (x >= 100) {
+    uint16_t q = div100(x);
+    putPair(dig + n, x - q * 100);
+    n += 2;
+    x = q;
+  }
+  if (x >= 10) {
+    putPair(dig + n, x);
+    n += 2;
+  } else if (x != 0)
+    dig[n++] = '0' + x;
+  return n;
+}
+
+// Splits four digits at a time with one 32-bit division until the rest is small enough for div100
+static uint8_t digits(uint32_t x, char* dig) {
+  uint8_t n = 0;
+  while (x > DIV100_MAX) {
+    uint32_t q = x / 10000;
+    uint16_t r = x - q * 10000;
+    uint16_t r1 = div100(r);
+    putPair(dig + n, r - r1 * 100);
+    putPair(dig + n + 2, r1);
+    n += 4;
+    x = q;
+  }
+  return n + digits((uint16_t)x, dig + n);
+}
 
 // Replaces all digits with '9' on overflow
 static void fillOverflow(char* pos, uint8_t size) {
@@ -43,13 +101,19 @@ uint8_t formatInvalid(char* pos, uint8_t size, fmt_t fmt) {
   return actualSize;
 }
 
-// commont template for all integral types
+// commont template for all integral types, digits are computed upfront by the
+// fastest digits() overload for magnitude of the type and then laid out
 template<typename T> inline uint8_t formatDecimalT(T x, char* pos, uint8_t size, fmt_t fmt) {
+  typedef typename FixNumUtil::Limits<T>::magnitude_t U;
   char sc = (fmt & FMT_SIGN) ? '+' : ' ';
+  U u = (U)x;
   if (x < 0) {
-    x = -x;
+    u = (U)0 - u;
     sc = '-';
   }
+  char dig[10];
+  uint8_t n = digits(u, dig);
+  uint8_t k = 0;
   uint8_t actualSize = 0;
   uint8_t first = (fmt & FMT_PREC) ? (fmt & FMT_PREC) + 1 : 0;
   char* ptr = pos + size;
@@ -58,7 +122,7 @@ template<typename T> inline uint8_t formatDecimalT(T x, char* pos, uint8_t size,
     if (i + 1 == first) {
       *ptr = '.';
       actualSize++;
-    } else if (!(fmt & FMT_ZERO) && x == 0 && i > first) {
+    } else if (!(fmt & FMT_ZERO) && k >= n && i > first) {
       *ptr = sc;
       if (sc != ' ')
         actualSize++;
@@ -67,12 +131,11 @@ template<typename T> inline uint8_t formatDecimalT(T x, char* pos, uint8_t size,
       *ptr = sc;
       actualSize++;
     } else {
-      *ptr = '0' + x % 10;
-      x /= 10;
+      *ptr = k < n ? dig[k++] : '0';
       actualSize++;
     }
   }
-  if (x != 0)
+  if (k < n)
     fillOverflow(pos, size);
   if (!(fmt & FMT_RIGHT) && actualSize < size)
     moveLeft(pos, size, actualSize);
@@ -98,3 +161,9 @@ uint8_t formatDecimal(uint8_t x, char* pos, uint8_t size, fmt_t fmt) {
 uint8_t formatDecimal(int8_t x, char* pos, uint8_t size, fmt_t fmt) {
   return formatDecimal((int16_t)x, pos, size, fmt);
 }
+
+// two digits straight from the table
+void formatPair(uint8_t x, char* pos) {
+  pos[0] = pgm_read_byte(&DIGIT_PAIRS[2 * x]);
+  pos[1] = pgm_read_byte(&DIGIT_PAIRS[2 * x + 1]);
+}
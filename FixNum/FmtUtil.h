@@ -26,4 +26,6 @@ uint8_t formatDecimal(int8_t x, char* pos, uint8_t size, fmt_t fmt = FMT_NONE);
 uint8_t formatDecimal(int16_t x, char* pos, uint8_t size, fmt_t fmt = FMT_NONE);
 uint8_t formatDecimal(int32_t x, char* pos, uint8_t size, fmt_t fmt = FMT_NONE);
 
+void formatPair(uint8_t x, char* pos); // writes two digits of x < 100 with a leading zero
+
 #endif
@@ -0,0 +1,113 @@
+#ifndef TRIMMED_MEAN_H_
+#define TRIMMED_MEAN_H_
+
+/*
+  Running trimmed mean of the last <size> samples for oversampling sensor readings.
+  Once there are more than 2 * <trim> samples, <trim> lowest and <trim> highest ones are
+  dropped as outliers and the rest are averaged into FixNum type <num_t>.
+
+  Samples are either <num_t> values themselves (add) or raw readings in 1/<scale> units (addRaw):
+
+    TrimmedMean<fixnum16_2, 12, 1, 16> filter; // DS18B20 raw readings are in 1/16 of degree
+    filter.addRaw(raw);
+    fixnum16_2 temp = filter.getValue();
+
+  Samples are kept in arrival order and in a sorted copy next to a running sum. A new sample
+  takes the place of the oldest one in the sorted copy and shifts by its change in rank, so
+  slowly changing readings cost a binary search and a few moves, while getValue only
+  subtracts <trim> values from each end of the sorted copy.
+*/
+
+#include "FixNum.h"
+
+template<class num_t, uint8_t size, uint8_t trim = 1, int32_t scale = num_t::multiplier> class TrimmedMean {
+public:
+  typedef typename num_t::mantissa_t sample_t;
+
+  inline TrimmedMean() { clear(); }
+
+  inline void clear() { _index = 0; _count = 0; _sum = 0; }
+  inline uint8_t count() const { return _count; }
+
+  void addRaw(sample_t x);
+  inline void add(num_t x) {
+    static_assert(scale == num_t::multiplier, "add takes num_t samples only when scale is num_t::multiplier, use addRaw");
+    addRaw(x.mantissa());
+  }
+
+  num_t getValue() const; // invalid when there are no samples
+
+private:
+  static_assert(size > 0 && size < 128, "size must be 1..127");
+
+  sample_t _ring[size];   // samples in arrival order, _index is the oldest when full
+  sample_t _sorted[size]; // first _count samples in ascending order
+  uint8_t _index;
+  uint8_t _count;
+  int32_t _sum;
+
+  uint8_t lowerBound(sample_t x, uint8_t n) const;
+};
+
+// ------------ implementation ------------
+
+template<class num_t, uint8_t size, uint8_t trim, int32_t scale> 
+uint8_t TrimmedMean<num_t, size, trim, scale>::lowerBound(sample_t x, uint8_t n) const {
+  uint8_t lo = 0;
+  while (lo < n) {
+    uint8_t mid = (lo + n) >> 1;
+    if (_sorted[mid] < x)
+      lo = mid + 1;
+    else
+      n = mid;
+  }
+  return lo;
+}
+
+template<class num_t, uint8_t size, uint8_t trim, int32_t scale> 
+void TrimmedMean<num_t, size, trim, scale>::addRaw(sample_t x) {
+  uint8_t i;
+  if (_count < size) {
+    // make room at the insertion point
+    i = _count++;
+    for (uint8_t j = lowerBound(x, i); i > j; i--)
+      _sorted[i] = _sorted[i - 1];
+  } else {
+    // reuse position of the oldest sample and move it to where x belongs
+    sample_t old = _ring[_index];
+    _sum -= old;
+    i = lowerBound(old, size);
+    while (i > 0 && _sorted[i - 1] > x) {
+      _sorted[i] = _sorted[i - 1];
+      i--;
+    }
+    while (i < size - 1 && _sorted[i + 1] < x) {
+      _sorted[i] = _sorted[i + 1];
+      i++;
+    }
+  }
+  _sorted[i] = x;
+  _sum += x;
+  _ring[_index] = x;
+  if (++_index == size)
+    _index = 0;
+}
+
+template<class num_t, uint8_t size, uint8_t trim, int32_t scale> 
+num_t TrimmedMean<num_t, size, trim, scale>::getValue() const {
+  if (_count == 0)
+    return num_t::invalid();
+  int32_t sum = _sum;
+  uint8_t count = _count;
+  if (count > 2 * trim) {
+    // drop outliers for even higher precision
+    for (uint8_t i = 0; i < trim; i++)
+      sum -= (int32_t)_sorted[i] + _sorted[count - 1 - i];
+    count -= 2 * trim;
+  }
+  if (scale == num_t::multiplier)
+    return num_t(sum / count);
+  return num_t((sum * num_t::multiplier) / (count * scale));
+}
+
+#endif
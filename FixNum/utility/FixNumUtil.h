@@ -40,12 +40,14 @@ namespace FixNumUtil {
   };
   
   template<> struct Limits<int16_t> {
+    typedef uint16_t magnitude_t;
     static const int16_t minValue = -0x7fff;
     static const int16_t maxValue =  0x7fff;
     static const uint8_t bufSize  = 8;
   };
   
   template<> struct Limits<int32_t> {
+    typedef uint32_t magnitude_t;
     static const int32_t minValue = -0x7fffffffL;
     static const int32_t maxValue =  0x7fffffffL;
     static const uint8_t bufSize  = 13;
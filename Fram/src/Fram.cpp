@@ -49,7 +49,34 @@ void FramClass::begin (uint8_t cp, SPISettings ss)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-uint8_t FramClass::write (uint16_t addr, uint8_t *data, uint16_t count)
+void FramClass::setClock (uint32_t clock)
+{
+  if (clock > FRAM_MAX_SPI_CLOCK)
+    clock = FRAM_MAX_SPI_CLOCK;
+
+  spiSettings = SPISettings(clock, MSBFIRST, SPI_MODE0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint8_t FramClass::write (uint16_t addr, const uint8_t *data, uint16_t count)
+{
+  if (addr + count > FRAM_SIZE)
+    return 1U;
+
+  if (count == 0U)
+    return 0U;
+
+  beginWrite(addr);
+  writeNext(data, count);
+  endWrite();
+
+  return 0U;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint8_t FramClass::read (uint16_t addr, uint8_t *dataBuffer, uint16_t count)
 {
   if (addr + count > FRAM_SIZE)
     return 1U;
@@ -57,6 +84,20 @@ uint8_t FramClass::write (uint16_t addr, uint8_t *data, uint16_t count)
   if (count == 0U)
     return 0U;
 
+  beginRead(addr);
+  readNext(dataBuffer, count);
+  endRead();
+
+  return 0U;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint8_t FramClass::beginWrite (uint16_t addr)
+{
+  if (addr >= FRAM_SIZE)
+    return 1U;
+
   assertCS();
   SPI.transfer(FRAM_CMD_WREN);
   deassertCS();
@@ -66,39 +107,89 @@ uint8_t FramClass::write (uint16_t addr, uint8_t *data, uint16_t count)
   SPI.transfer(FRAM_CMD_WRITE);
   SPI.transfer16(addr);
 
-  for (uint16_t i = 0; i < count; ++i)
-    SPI.transfer(data[i]);
-
-  deassertCS();
+  return 0U;
+}
 
-  assertCS();
-  SPI.transfer(FRAM_CMD_WRDI);
-  deassertCS();
+////////////////////////////////////////////////////////////////////////////////
 
-  return 0U;
+void FramClass::writeNext (const uint8_t *data, uint16_t count)
+{
+  // SPI.transfer(buf, n) overwrites buf with received bytes, so copy through a chunk
+  uint8_t chunk[FRAM_BULK_CHUNK];
+
+  while (count > 0U)
+  {
+    uint8_t n = (count < FRAM_BULK_CHUNK) ? (uint8_t) count : FRAM_BULK_CHUNK;
+    memcpy(chunk, data, n);
+    SPI.transfer(chunk, n);
+    data += n;
+    count -= n;
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-uint8_t FramClass::read (uint16_t addr, uint8_t *dataBuffer, uint16_t count)
+uint8_t FramClass::beginRead (uint16_t addr)
 {
-  if (addr + count > FRAM_SIZE)
+  if (addr >= FRAM_SIZE)
     return 1U;
 
-  if (count == 0U)
-    return 0U;
-
   assertCS();
 
   SPI.transfer(FRAM_CMD_READ);
   SPI.transfer16(addr);
 
-  for (uint16_t i=0; i < count; ++i)
-    dataBuffer[i] = SPI.transfer(0x00);
+  return 0U;
+}
 
-  deassertCS();
+////////////////////////////////////////////////////////////////////////////////
 
-  return 0U;
+void FramClass::readNext (uint8_t *dataBuffer, uint16_t count)
+{
+  // Chip ignores SI while shifting out data, so whatever is in the buffer can be sent
+  if (count > 0U)
+    SPI.transfer(dataBuffer, count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint16_t FramClass::crc16 (uint16_t addr, uint16_t count, uint16_t crc)
+{
+  if (addr + count > FRAM_SIZE || count == 0U)
+    return crc;
+
+  uint8_t chunk[FRAM_BULK_CHUNK];
+
+  beginRead(addr);
+
+  while (count > 0U)
+  {
+    uint8_t n = (count < FRAM_BULK_CHUNK) ? (uint8_t) count : FRAM_BULK_CHUNK;
+    readNext(chunk, n);
+    crc = framCrc16(chunk, n, crc);
+    count -= n;
+  }
+
+  endRead();
+
+  return crc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint16_t framCrc16 (const void *data, uint16_t count, uint16_t crc)
+{
+  const uint8_t *p = (const uint8_t *) data;
+
+  while (count-- > 0U)
+  {
+    crc ^= (uint16_t) *p++ << 8;
+
+    for (uint8_t i = 0; i < 8; ++i)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+
+  return crc;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -28,6 +28,15 @@
 
 #define FRAM_DEFAULT_SPI_SETTINGS SPISettings(1000000, MSBFIRST, SPI_MODE0)
 
+// MB85RS64A is specified up to 20 MHz, the SPI library clamps it to what the MCU can do
+#define FRAM_MAX_SPI_CLOCK ((uint32_t) 20000000)
+
+// Stack buffer used to stream writes through SPI.transfer(buf, n)
+#define FRAM_BULK_CHUNK ((uint8_t) 32)
+
+// CRC-16/CCITT initial value for framCrc16
+#define FRAM_CRC_INIT ((uint16_t) 0xFFFF)
+
 // MB85RS64A - 64 K (8 K x 8) bit SPI FRAM
 #define FRAM_SIZE ((uint16_t) 0x2000)
 
@@ -49,12 +58,37 @@ class FramClass
 
     void begin (uint8_t csPin = FRAM_DEFAULT_CS_PIN, SPISettings ss = FRAM_DEFAULT_SPI_SETTINGS);
 
-    uint8_t write (uint16_t addr, uint8_t *data, uint16_t count);
+    // Changes SPI clock for subsequent transfers (up to FRAM_MAX_SPI_CLOCK)
+    void setClock (uint32_t clock);
+
+    uint8_t write (uint16_t addr, const uint8_t *data, uint16_t count);
     uint8_t read (uint16_t addr, uint8_t *dataBuffer, uint16_t count);
+
+    // Streaming write: one WRITE command, then any number of writeNext calls.
+    // Write enable latch is reset by the chip when CS goes high after WRITE,
+    // so no WRDI is needed in endWrite.
+    uint8_t beginWrite (uint16_t addr);
+    void writeNext (const uint8_t *data, uint16_t count);
+    inline void endWrite() { deassertCS(); };
+
+    // Streaming read: one READ command, then any number of readNext calls
+    // continue from the current address (wrapping at FRAM_SIZE). SPI stays
+    // in use until endRead, so don't touch other SPI devices in between.
+    uint8_t beginRead (uint16_t addr);
+    void readNext (uint8_t *dataBuffer, uint16_t count);
+    inline void endRead() { deassertCS(); };
+
+    // CRC-16/CCITT of the given range, streamed in a single READ
+    uint16_t crc16 (uint16_t addr, uint16_t count, uint16_t crc = FRAM_CRC_INIT);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// CRC-16/CCITT (poly 0x1021) of a RAM buffer, chainable via crc argument
+uint16_t framCrc16 (const void *data, uint16_t count, uint16_t crc = FRAM_CRC_INIT);
+
+////////////////////////////////////////////////////////////////////////////////
+
 extern FramClass Fram;
 
 
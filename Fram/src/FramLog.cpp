@@ -0,0 +1,322 @@
+//  Power-fail safe ring log of variable size records in SPI FRAM
+//  Copyright (C) 2017  Industruino <connect@industruino.com>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "FramLog.h"
+
+
+#define HEADER_CRC_SIZE (sizeof(FramLogHeader) - sizeof(uint16_t))
+
+////////////////////////////////////////////////////////////////////////////////
+
+FramLog::FramLog (uint16_t b, uint16_t size)
+{
+  base = b;
+  dataStart = b + 2 * sizeof(FramLogHeader);
+  dataEnd = b + size;
+  memset(&hdr, 0, sizeof(hdr));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramLog::begin()
+{
+  FramLogHeader h[2];
+  bool valid[2];
+
+  Fram.read(base, (uint8_t *) h, sizeof(h));
+
+  for (uint8_t i = 0; i < 2; ++i)
+    valid[i] = h[i].magic == FRAM_LOG_MAGIC &&
+               h[i].crc == framCrc16(&h[i], HEADER_CRC_SIZE) &&
+               h[i].head >= dataStart && h[i].head < dataEnd &&
+               h[i].tail >= dataStart && h[i].tail < dataEnd;
+
+  if (valid[0] && valid[1])
+    hdr = h[(int16_t) (h[1].seq - h[0].seq) > 0 ? 1 : 0];
+  else if (valid[0] || valid[1])
+    hdr = h[valid[1] ? 1 : 0];
+  else
+  {
+    clear();
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void FramLog::clear()
+{
+  hdr.magic = FRAM_LOG_MAGIC;
+  hdr.head = dataStart;
+  hdr.tail = dataStart;
+  hdr.count = 0U;
+  commit();
+  commit(); // both copies
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramLog::commit()
+{
+  hdr.seq++;
+  hdr.crc = framCrc16(&hdr, HEADER_CRC_SIZE);
+  return Fram.write(base + (hdr.seq & 1) * sizeof(FramLogHeader), (const uint8_t *) &hdr, sizeof(hdr)) == 0U;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint8_t FramLog::readLen (uint16_t pos)
+{
+  uint8_t len;
+
+  if (pos >= dataEnd || Fram.read(pos, &len, 1U) != 0U)
+    return FRAM_LOG_WRAP;
+
+  return len;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramLog::dropOldest()
+{
+  if (hdr.count == 0U)
+    return false;
+
+  uint8_t len = readLen(hdr.tail);
+
+  if (len == FRAM_LOG_WRAP)
+  {
+    hdr.tail = dataStart;
+    len = readLen(hdr.tail);
+  }
+
+  hdr.tail += len + FRAM_LOG_OVERHEAD;
+
+  if (hdr.tail >= dataEnd)
+    hdr.tail = dataStart;
+
+  if (--hdr.count == 0U)
+    hdr.tail = hdr.head;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramLog::append (const void *data, uint8_t len)
+{
+  uint16_t recSize = len + FRAM_LOG_OVERHEAD;
+
+  if (len > FRAM_LOG_MAX_DATA || recSize >= dataEnd - dataStart)
+    return false;
+
+  bool dropped = false;
+  uint16_t pos;
+
+  for (;;)
+  {
+    if (hdr.count == 0U)
+      hdr.head = hdr.tail = dataStart;
+
+    // head must never catch up with a non-empty tail
+    if (hdr.tail <= hdr.head && hdr.count == 0U)
+      pos = hdr.head;
+    else if (hdr.tail <= hdr.head && hdr.head + recSize <= dataEnd && (hdr.head + recSize < dataEnd || hdr.tail != dataStart))
+      pos = hdr.head;
+    else if (hdr.tail <= hdr.head && dataStart + recSize < hdr.tail)
+      pos = dataStart;
+    else if (hdr.tail > hdr.head && hdr.head + recSize < hdr.tail)
+      pos = hdr.head;
+    else
+    {
+      dropOldest();
+      dropped = true;
+      continue;
+    }
+
+    break;
+  }
+
+  // Make the space taken from old records invisible before overwriting it
+  if (dropped && !commit())
+    return false;
+
+  uint16_t crc = framCrc16(data, len);
+  uint8_t crcBytes[2] = { (uint8_t) crc, (uint8_t) (crc >> 8) };
+
+  if (Fram.beginWrite(pos) != 0U)
+    return false;
+
+  Fram.writeNext(&len, 1U);
+  Fram.writeNext((const uint8_t *) data, len);
+  Fram.writeNext(crcBytes, sizeof(crcBytes));
+  Fram.endWrite();
+
+  if (pos != hdr.head)
+  {
+    uint8_t wrap = FRAM_LOG_WRAP;
+    Fram.write(hdr.head, &wrap, 1U);
+  }
+
+  hdr.head = pos + recSize;
+
+  if (hdr.head >= dataEnd)
+    hdr.head = dataStart;
+
+  hdr.count++;
+
+  return commit();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int FramLog::peek (void *buf, uint8_t size)
+{
+  if (hdr.count == 0U)
+    return -1;
+
+  uint16_t pos = hdr.tail;
+  uint8_t len = readLen(pos);
+
+  if (len == FRAM_LOG_WRAP)
+  {
+    pos = dataStart;
+    len = readLen(pos);
+  }
+
+  if (len > size || len == FRAM_LOG_WRAP)
+    return -2;
+
+  uint8_t crc[2];
+
+  Fram.beginRead(pos + 1);
+  Fram.readNext((uint8_t *) buf, len);
+  Fram.readNext(crc, sizeof(crc));
+  Fram.endRead();
+
+  if (word(crc[1], crc[0]) != framCrc16(buf, len))
+    return -2;
+
+  return len;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int FramLog::read (void *buf, uint8_t size)
+{
+  int len = peek(buf, size);
+
+  if (len >= 0)
+    drop();
+
+  return len;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramLog::drop()
+{
+  return dropOldest() && commit();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint16_t FramLog::scan (uint8_t *buf, uint8_t size, FramLogCallback callback, void *arg)
+{
+  uint16_t visited = 0U;
+  uint16_t pos = hdr.tail;
+
+  Fram.beginRead(pos);
+
+  for (uint16_t i = 0U; i < hdr.count; ++i)
+  {
+    uint8_t len;
+
+    Fram.readNext(&len, 1U);
+
+    if (len == FRAM_LOG_WRAP)
+    {
+      pos = dataStart;
+      Fram.endRead();
+      Fram.beginRead(pos);
+      Fram.readNext(&len, 1U);
+    }
+
+    uint8_t crc[2];
+    bool ok = len <= size;
+
+    if (ok)
+      Fram.readNext(buf, len);
+    else
+    {
+      // Too large for the buffer, skip over it
+      uint8_t skip[FRAM_BULK_CHUNK];
+
+      for (uint8_t n = len; n > 0U; )
+      {
+        uint8_t k = n < FRAM_BULK_CHUNK ? n : FRAM_BULK_CHUNK;
+        Fram.readNext(skip, k);
+        n -= k;
+      }
+    }
+
+    Fram.readNext(crc, sizeof(crc));
+
+    pos += len + FRAM_LOG_OVERHEAD;
+
+    if (ok && word(crc[1], crc[0]) == framCrc16(buf, len))
+    {
+      visited++;
+
+      if (!callback(buf, len, arg))
+        break;
+    }
+
+    if (pos >= dataEnd)
+    {
+      pos = dataStart;
+      Fram.endRead();
+      Fram.beginRead(pos);
+    }
+  }
+
+  Fram.endRead();
+
+  return visited;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint16_t FramLog::capacity()
+{
+  return dataEnd - dataStart - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint16_t FramLog::used()
+{
+  if (hdr.count == 0U)
+    return 0U;
+
+  if (hdr.tail < hdr.head)
+    return hdr.head - hdr.tail;
+
+  return dataEnd - hdr.tail + hdr.head - dataStart;
+}
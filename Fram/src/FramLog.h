@@ -0,0 +1,100 @@
+//  Power-fail safe ring log of variable size records in SPI FRAM
+//  Copyright (C) 2017  Industruino <connect@industruino.com>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __FRAM_LOG_H__
+#define __FRAM_LOG_H__
+
+#include "Fram.h"
+
+
+#define FRAM_LOG_MAGIC ((uint16_t) 0x4C47)
+
+// Record is [len][payload][crc16], len 0xFF marks the unused tail end before wrap
+#define FRAM_LOG_WRAP     ((uint8_t) 0xFF)
+#define FRAM_LOG_MAX_DATA ((uint8_t) 0xFE)
+#define FRAM_LOG_OVERHEAD ((uint8_t) 3)
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct FramLogHeader
+{
+  uint16_t magic;
+  uint16_t seq;
+  uint16_t head;
+  uint16_t tail;
+  uint16_t count;
+  uint16_t crc;
+};
+
+// Called for each record by FramLog::scan while FRAM is being read,
+// must not use SPI. Returning false stops the scan.
+typedef bool (*FramLogCallback) (const uint8_t *data, uint8_t len, void *arg);
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Two copies of the header are kept at the start of the region and written
+// alternately with an increasing sequence number, so a power loss in the
+// middle of any write leaves either the old or the new state intact:
+// - record payload is written before the header that makes it visible;
+// - when old records have to be dropped to make room, the advanced tail
+//   is committed before their space is overwritten.
+class FramLog
+{
+  private:
+
+    uint16_t base;
+    uint16_t dataStart;
+    uint16_t dataEnd;
+    FramLogHeader hdr;
+
+    bool commit();
+    bool dropOldest();
+    uint8_t readLen (uint16_t pos);
+
+  public:
+
+    FramLog (uint16_t base, uint16_t size);
+
+    // Mounts the log, formats the region if no valid header found.
+    // Returns true when an existing log was recovered.
+    bool begin();
+    void clear();
+
+    // Appends a record, dropping the oldest ones when there is no room
+    bool append (const void *data, uint8_t len);
+
+    // Copies the oldest record into buf. Returns its length, -1 when empty,
+    // -2 when it does not fit into size or fails CRC check.
+    int peek (void *buf, uint8_t size);
+    // Same as peek but also removes the record
+    int read (void *buf, uint8_t size);
+    // Removes the oldest record
+    bool drop();
+
+    // Visits records from oldest to newest, streaming the log with a single
+    // READ command per contiguous part. Records failing CRC are skipped.
+    // Returns the number of records visited.
+    uint16_t scan (uint8_t *buf, uint8_t size, FramLogCallback callback, void *arg = 0);
+
+    inline uint16_t count() { return hdr.count; };
+    inline bool empty() { return hdr.count == 0U; };
+    uint16_t capacity();
+    uint16_t used();
+};
+
+
+#endif   // __FRAM_LOG_H__
@@ -0,0 +1,207 @@
+//  Versioned, CRC checked struct persistence in SPI FRAM with A/B copies
+//  Copyright (C) 2017  Industruino <connect@industruino.com>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "FramRecord.h"
+#include <stddef.h>
+
+
+#define HEADER_CRC_SIZE offsetof(FramRecordHeader, crc)
+
+////////////////////////////////////////////////////////////////////////////////
+
+FramRecord::FramRecord (uint16_t a, void *d, uint16_t s, uint8_t v)
+{
+  addr = a;
+  data = (uint8_t *) d;
+  shadow = 0;
+  size = s;
+  version = v;
+  seq = 0U;
+  active = 0U;
+  synced = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+FramRecord::~FramRecord()
+{
+  free(shadow);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramRecord::begin()
+{
+  if (!shadow)
+    shadow = (uint8_t *) malloc(size);
+
+  if (!shadow)
+    return false;
+
+  return load();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint16_t FramRecord::headerCrc (FramRecordHeader *hdr)
+{
+  return framCrc16(hdr, HEADER_CRC_SIZE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramRecord::readHeader (uint8_t copy, FramRecordHeader *hdr)
+{
+  uint16_t a = copyAddr(copy);
+
+  if (a + sizeof(FramRecordHeader) + size > FRAM_SIZE ||
+      Fram.read(a, (uint8_t *) hdr, sizeof(FramRecordHeader)) != 0U)
+    return false;
+
+  if (hdr->version != version || hdr->size != size)
+    return false;
+
+  return hdr->crc == Fram.crc16(a + sizeof(FramRecordHeader), size, headerCrc(hdr));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramRecord::load()
+{
+  if (!shadow)
+    return false;
+
+  FramRecordHeader h[2];
+  bool valid[2];
+
+  for (uint8_t i = 0; i < 2; ++i)
+    valid[i] = readHeader(i, &h[i]);
+
+  synced = false;
+
+  if (!valid[0] && !valid[1])
+  {
+    seq = 0U;
+    active = 0U;
+    return false;
+  }
+
+  if (valid[0] && valid[1])
+    active = (int16_t) (h[1].seq - h[0].seq) > 0 ? 1 : 0;
+  else
+    active = valid[1] ? 1 : 0;
+
+  seq = h[active].seq;
+
+  // save() leaves the newer copy with an even seq one above the other one
+  synced = valid[0] && valid[1] && (seq & 1) == 0 && (uint16_t) (seq - h[1 - active].seq) == 1;
+
+  if (Fram.read(copyAddr(active) + sizeof(FramRecordHeader), shadow, size) != 0U)
+  {
+    synced = false;
+    return false;
+  }
+
+  memcpy(data, shadow, size);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramRecord::changed()
+{
+  return !synced || !shadow || memcmp(data, shadow, size) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramRecord::writeCopy (uint8_t copy, uint16_t s, bool all)
+{
+  uint16_t a = copyAddr(copy);
+  uint16_t d = a + sizeof(FramRecordHeader);
+
+  if (a + sizeof(FramRecordHeader) + size > FRAM_SIZE)
+    return false;
+
+  if (all)
+    Fram.write(d, data, size);
+  else
+  {
+    uint16_t i = 0U;
+
+    while (i < size)
+    {
+      if (data[i] == shadow[i])
+      {
+        ++i;
+        continue;
+      }
+
+      uint16_t start = i;
+      uint16_t end = ++i;
+
+      // Extend the run over short unchanged gaps
+      while (i < size && i - end < FRAM_RECORD_GAP)
+      {
+        if (data[i] != shadow[i])
+          end = i + 1;
+        ++i;
+      }
+
+      Fram.write(d + start, data + start, end - start);
+      i = end;
+    }
+  }
+
+  FramRecordHeader hdr;
+
+  hdr.seq = s;
+  hdr.size = size;
+  hdr.version = version;
+  hdr.reserved = 0U;
+  hdr.crc = framCrc16(data, size, headerCrc(&hdr));
+
+  return Fram.write(a, (const uint8_t *) &hdr, sizeof(hdr)) == 0U;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FramRecord::save()
+{
+  if (!shadow)
+    return false;
+
+  if (!changed())
+    return true;
+
+  // Stale copy first, the one load() picked stays valid until it is rewritten.
+  // Make sure it lands on an even seq, so load() can tell both are in sync.
+  uint16_t s = (seq + 3U) & ~1U;
+
+  if (!writeCopy(1 - active, s - 1U, !synced) || !writeCopy(active, s, !synced))
+  {
+    synced = false;
+    return false;
+  }
+
+  seq = s;
+  synced = true;
+  memcpy(shadow, data, size);
+
+  return true;
+}
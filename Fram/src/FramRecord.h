@@ -0,0 +1,86 @@
+//  Versioned, CRC checked struct persistence in SPI FRAM with A/B copies
+//  Copyright (C) 2017  Industruino <connect@industruino.com>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __FRAM_RECORD_H__
+#define __FRAM_RECORD_H__
+
+#include "Fram.h"
+
+
+// Unchanged runs shorter than this are rewritten rather than split into
+// another WRITE command (which costs WREN + command + address bytes)
+#define FRAM_RECORD_GAP ((uint8_t) 4)
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct FramRecordHeader
+{
+  uint16_t seq;
+  uint16_t size;
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t crc;   // over seq, size, version and data
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A fixed-size slot holding a copy of a RAM struct. The slot keeps two
+// copies, each with its own header:
+// - save writes copy B, then its header, then the same bytes and header
+//   to copy A, so a reset at any point leaves one complete valid copy;
+// - a RAM shadow of the stored data is kept, and only the byte runs
+//   that differ from it are written.
+// Slots are laid out by chaining: FramRecord b(a.end(), ...).
+class FramRecord
+{
+  private:
+
+    uint16_t addr;
+    uint8_t *data;
+    uint8_t *shadow;
+    uint16_t size;
+    uint8_t version;
+    uint16_t seq;
+    uint8_t active;   // copy load() picked as the newest
+    bool synced;      // both copies hold shadow contents
+
+    inline uint16_t copyAddr (uint8_t copy) { return addr + copy * (sizeof(FramRecordHeader) + size); };
+    bool readHeader (uint8_t copy, FramRecordHeader *hdr);
+    uint16_t headerCrc (FramRecordHeader *hdr);
+    bool writeCopy (uint8_t copy, uint16_t s, bool all);
+
+  public:
+
+    FramRecord (uint16_t addr, void *data, uint16_t size, uint8_t version = 1);
+    ~FramRecord();
+
+    // Allocates the shadow and loads the newest valid copy into data.
+    // Returns false (leaving data untouched) when there is none or it has
+    // a different version or size; the next save then writes it in full.
+    bool begin();
+    bool load();
+
+    // Writes bytes changed since the last load/save to both copies
+    bool save();
+    bool changed();
+
+    inline uint16_t end() { return addr + 2 * (sizeof(FramRecordHeader) + size); };
+    inline uint16_t sequence() { return seq; };
+};
+
+
+#endif   // __FRAM_RECORD_H__
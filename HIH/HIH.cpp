@@ -51,19 +51,21 @@ inline uint8_t HIH::receive() {
   if (data1.h != data1.h || data2.t != data2.t)
     return 3; // different data second time
   // update temp and rh
-  _temp = fixnum32_1::scale(data1.t) * 165 / ((1 << 14) - 2) - 40;
-  if (!_temp)
+  temp_t temp = fixnum32_1::scale(data1.t) * 165 / ((1 << 14) - 2) - 40;
+  if (!temp)
     return 4; // invalid temp reading
-  _rh = fixnum32_1::scale(data1.h) * 100 / ((1 << 14) - 2);
-  if (!_rh)
+  rh_t rh = fixnum32_1::scale(data1.h) * 100 / ((1 << 14) - 2);
+  if (!rh)
     return 5; // invalid RH reading
+  _temp.add(temp);
+  _rh.add(rh);
   return 0;
 }
 
 bool HIH::retry() {
   _timeout.reset(RETRY);
   _state = STATE_MEASURE;
-  if (_temp) {
+  if (_temp.count() > 0) {
     if (_retry_count++ >= RETRY_LIMIT) {
       _temp.clear();
       _rh.clear();
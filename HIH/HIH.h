@@ -25,11 +25,19 @@
 #include <FixNum.h>
 #include <Timeout.h>
 #include <TWIMaster.h>
+#include <TrimmedMean.h>
+
+// Number of readings in running average, one per 5 seconds
+#ifndef HIH_WINDOW
+#define HIH_WINDOW 5
+#endif
 
 class HIH {
 public:
   typedef fixnum16_1 temp_t;  
   typedef fixnum16_1 rh_t;  
+  typedef TrimmedMean<temp_t, HIH_WINDOW> temp_filter_t;
+  typedef TrimmedMean<rh_t, HIH_WINDOW> rh_filter_t;
 
   HIH();
   bool check();        // true when something change (new reading taken or old one is cleared on too many errors)
@@ -39,8 +47,8 @@ public:
 
 private:
   bool _valid;
-  temp_t _temp;
-  rh_t _rh;
+  temp_filter_t _temp;
+  rh_filter_t _rh;
   Timeout _timeout;
   uint8_t _state; // 0 - send measure cmd, 1 - receive measurement
   uint8_t _last_error;
@@ -53,11 +61,11 @@ private:
 // ------------ short method implementations are inline here ------------
 
 inline HIH::temp_t HIH::getTemp() {
-  return _temp;
+  return _temp.getValue();
 }
 
 inline HIH::rh_t HIH::getRH() {
-  return _rh;
+  return _rh.getValue();
 }
 
 inline uint16_t HIH::getState() {
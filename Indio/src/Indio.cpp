@@ -117,7 +117,6 @@ const int DAC_current_high_uA[3] = {0,19530,19530}; //corresponding uA for high
 // read mcp342x data
 float IndioClass::analogRead(int pin)
 {
-  float current, voltage;
   long data;
   
     if (pin != previouspin)
@@ -126,11 +125,35 @@ float IndioClass::analogRead(int pin)
         delay(sample_rate);
         previouspin = pin;
     }
-  // pointer used to form int32 data
-  uint8_t *p = (uint8_t *)&data;
   // timeout - not really needed?
   uint32_t start = millis();
   do {
+    int s = mcp342xRead(data);
+	if (mode_ADC[pin] >= mA && mode_ADC[pin] <= V10_raw)
+	{
+	return analogConvert(pin, data);
+	}
+      
+      
+    if ((s & MCP342X_BUSY) == 0);
+  } while (millis() - start < 500); //allows rollover of millis()
+  Serial.println("read timeout"); 
+}
+//------------------------------------------------------------------------------
+// write mcp342x configuration byte
+    int IndioClass::mcp342xWrite(int config)
+    {
+     Wire.beginTransmission(MCP3422_ADDRESS);
+     Wire.write(config); 
+     return Wire.endTransmission();
+    }
+
+//------------------------------------------------------------------------------
+// read mcp342x data register into data, returns the config/status byte
+    int IndioClass::mcp342xRead(long &data)
+    {
+  // pointer used to form int32 data
+  uint8_t *p = (uint8_t *)&data;
     // assume 18-bit mode
     Wire.requestFrom(MCP3422_ADDRESS, 4);
     if (Wire.available() != 4) {
@@ -149,59 +172,100 @@ float IndioClass::analogRead(int pin)
       p[1] = p[2];
       p[2] = p[3];
     }
-	if (mode_ADC[pin]==1)
-	{
-	current=map(((data/mvDivisor)+2048), ADC_current_low_raw[pin], ADC_current_high_raw[pin], ADC_current_low_uA[pin], ADC_current_high_uA[pin]);
-	return current /= 1000;
-	}
-	if (mode_ADC[pin]==2)
-	{
-	voltage=map(((data/mvDivisor)+2048), ADC_voltage_low_raw[pin], ADC_voltage_high_raw[pin], ADC_voltage_low_mV[pin], ADC_voltage_high_mV[pin]);
-	return voltage /= 1000;
-	}
-	if (mode_ADC[pin]==3)
-	{
-	voltage=map(((data/mvDivisor)+2048), ADC_voltage_low_raw[pin], ADC_voltage_high_raw[pin], ADC_voltage_low_mV[pin], ADC_voltage_high_mV[pin]);
-	return voltage /= 1000;
-	}
-	if (mode_ADC[pin]==4)
-	{
-	current=map(((data/mvDivisor)+2048), ADC_current_low_raw[pin], ADC_current_high_raw[pin], ADC_current_low_uA[pin], ADC_current_high_uA[pin]);
-	return ((((current-4000)/16000))*100);
-	}
-	if (mode_ADC[pin]==5)
-	{
-	voltage=map(((data/mvDivisor)+2048), ADC_voltage_low_raw[pin], ADC_voltage_high_raw[pin], ADC_voltage_low_mV[pin], ADC_voltage_high_mV[pin]);
-	return (((voltage/10000))*100);
-	}
-	if (mode_ADC[pin]==6)
-	{
-	voltage=map(((data/mvDivisor)+2048), ADC_voltage_low_raw[pin], ADC_voltage_high_raw[pin], ADC_voltage_low_mV[pin], ADC_voltage_high_mV[pin]);
-	return (((voltage/5000))*100);
-	}
-	if (mode_ADC[pin]==7)
-	{
-	current=((data/mvDivisor)+2048);
-	return current;
-	}
-    if (mode_ADC[pin]==8)
+    return s;
+    }
+
+//------------------------------------------------------------------------------
+// precompute the two point calibration of a channel as fixed point slope and offset,
+// so that a reading converts with one long multiply instead of float map()
+    void IndioClass::analogCalibrate(int pin, long lowRaw, long highRaw, long low, long high)
     {
-    voltage=((data/mvDivisor)+2048);
-    return voltage;
+     // value = low + (data / mvDivisor + 2048 - lowRaw) * (high - low) / (highRaw - lowRaw)
+     float scale = (float)(high - low) / (highRaw - lowRaw);
+     calSlope[pin] = lround(scale * 65536 / mvDivisor);
+     calOffset[pin] = lround(low + (2048 - lowRaw) * scale);
     }
-      
-      
-    if ((s & MCP342X_BUSY) == 0);
-  } while (millis() - start < 500); //allows rollover of millis()
-  Serial.println("read timeout"); 
-}
+
 //------------------------------------------------------------------------------
-// write mcp342x configuration byte
-    int IndioClass::mcp342xWrite(int config)
+// convert mcp342x data to the units of the channel mode
+    float IndioClass::analogConvert(int pin, long data)
     {
-     Wire.beginTransmission(MCP3422_ADDRESS);
-     Wire.write(config); 
-     Wire.endTransmission();
+     long value = ((data * calSlope[pin] + 0x8000) >> 16) + calOffset[pin]; // uA or mV
+     switch (mode_ADC[pin]) {
+         case mA:
+         case V10:
+         case V5:
+             return value / 1000.0;
+         case mA_p:
+             return (value - 4000) / 16000.0 * 100;
+         case V10_p:
+             return value / 10000.0 * 100;
+         case V5_p:
+             return value / 5000.0 * 100;
+         default: // mA_raw, V10_raw
+             return (data / mvDivisor) + 2048;
+     }
+    }
+
+//------------------------------------------------------------------------------
+    void IndioClass::analogScanBegin()
+    {
+     for (int pin = 1; pin <= 4; pin++) {
+         scanTime[pin] = 0;
+     }
+     scanPin = 0;
+     analogScanNext();
+    }
+
+    void IndioClass::analogScanEnd()
+    {
+     scanPin = 0;
+    }
+
+// start converting the next channel with a mode set, round-robin over CH1-CH4
+    void IndioClass::analogScanNext()
+    {
+     int pin = scanPin;
+     for (int i = 0; i < 4; i++) {
+         pin = pin % 4 + 1;
+         if (mode_ADC[pin]) {
+             // in continuous mode a single scanned channel needs no new config
+             if (pin != previouspin) {
+                 this->mcp342xWrite(adcConfig[pin]);
+                 previouspin = pin;
+             }
+             scanPin = pin;
+             scanStart = millis();
+             return;
+         }
+     }
+     scanPin = 0; // no channel set up
+    }
+
+    bool IndioClass::poll()
+    {
+     // don't touch the bus before the conversion can be done
+     if (scanPin == 0 || millis() - scanStart < (unsigned long)sample_rate) {
+         return false;
+     }
+     long data;
+     if (mcp342xRead(data) & MCP342X_BUSY) {
+         return false; // not ready yet, try on the next poll
+     }
+     scanData[scanPin] = data;
+     scanTime[scanPin] = millis();
+     analogScanNext();
+     return true;
+    }
+
+    float IndioClass::analogValue(int pin)
+    {
+     return analogConvert(pin, scanData[pin]);
+    }
+
+    unsigned long IndioClass::analogTime(int pin)
+    {
+     return scanTime[pin];
     }
   
     //------------------------------------------------------------------------------
@@ -411,6 +475,14 @@ float IndioClass::analogRead(int pin)
           adcConfig[pin] = MCP342X_START | MCP342X_CONTINUOUS | (pin-1) << 5 | res<< 2;
           mode_ADC[pin]=8;
 	  }
+	  if (mode == mA || mode == mA_p || mode == mA_raw)
+	  {
+	     analogCalibrate(pin, ADC_current_low_raw[pin], ADC_current_high_raw[pin], ADC_current_low_uA[pin], ADC_current_high_uA[pin]);
+	  }
+	  else
+	  {
+	     analogCalibrate(pin, ADC_voltage_low_raw[pin], ADC_voltage_high_raw[pin], ADC_voltage_low_mV[pin], ADC_voltage_high_mV[pin]);
+	  }
 	  this->flushOutput2();
 
 	}
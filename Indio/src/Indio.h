@@ -60,6 +60,19 @@ class IndioClass
     int previous_sample;
     double mvDivisor;
     int startupState = 1;
+    // calibration precomputed by analogReadMode(): uA or mV = (data * calSlope >> 16) + calOffset
+    long calSlope[5];
+    long calOffset[5];
+    // analog scan: channel being converted (0 = not scanning), its start time and latest readings
+    int scanPin;
+    unsigned long scanStart;
+    long scanData[5];
+    unsigned long scanTime[5];
+
+    int mcp342xRead(long &data);
+    void analogCalibrate(int pin, long lowRaw, long highRaw, long low, long high);
+    float analogConvert(int pin, long data);
+    void analogScanNext();
 
   public:
     
@@ -78,6 +91,17 @@ class IndioClass
 // read mcp342x data
     float analogRead(int pin);
 //------------------------------------------------------------------------------
+// non-blocking round-robin scan of all channels set up with analogReadMode()
+    void analogScanBegin();
+
+    void analogScanEnd();
+// call from loop(), returns true when a new reading was stored
+    bool poll();
+// latest scanned value of a channel, in the units of analogRead()
+    float analogValue(int pin);
+// millis() when that value was read, 0 if none yet
+    unsigned long analogTime(int pin);
+//------------------------------------------------------------------------------
 // write mcp342x configuration byte
     int mcp342xWrite(int config);
       //------------------------------------------------------------------------------
@@ -138,7 +138,8 @@ void SHT1X::reset() {
   _state = SHT1X_STATE_MEAS_TEMP;
   _fail_count = 0;
   _temp.clear();
-  _rh.clear();
+  _temp_filter.clear();
+  _rh_filter.clear();
 }
 
 boolean SHT1X::send_cmd(uint8_t cmd) {
@@ -318,7 +319,11 @@ bool SHT1X::check() {
       if (data == 0) {
         _last_error = 6; // NO RH
       } else if (verify_crc8(SHT1X_MEAS_RH_CMD, data, crc)) {
-        _rh = rdg2rh(data, _temp);
+        rh_t rh = rdg2rh(data, _temp);
+        if (_temp && rh) {
+          _temp_filter.add(_temp);
+          _rh_filter.add(rh);
+        }
         _state = SHT1X_STATE_MEAS_TEMP;
         _last_error = 0;
         _timeout.reset(COOLDOWN_INTERVAL);
@@ -41,12 +41,20 @@
 #include <Arduino.h>
 #include <FixNum.h>
 #include <Timeout.h>
+#include <TrimmedMean.h>
+
+// Number of readings in running average, one per 10 seconds
+#ifndef SHT1X_WINDOW
+#define SHT1X_WINDOW 3
+#endif
 
 class SHT1X
 {
 public:
   typedef fixnum16_2 temp_t;
   typedef fixnum16_1 rh_t;
+  typedef TrimmedMean<temp_t, SHT1X_WINDOW> temp_filter_t;
+  typedef TrimmedMean<rh_t, SHT1X_WINDOW> rh_filter_t;
 
   SHT1X(uint8_t clock_pin, uint8_t data_pin);
   bool check();
@@ -72,18 +80,19 @@ private:
   Timeout _timeout;
   uint8_t _fail_count;
 
-  temp_t _temp;
-  rh_t _rh;
+  temp_t _temp; // last reading for RH compensation
+  temp_filter_t _temp_filter;
+  rh_filter_t _rh_filter;
 };
 
 // ------------ short method implementations are inline here ------------
 
 inline SHT1X::temp_t SHT1X::getTemp() {
-  return _temp;
+  return _temp_filter.getValue();
 }
 
 inline SHT1X::rh_t SHT1X::getRH() {
-  return _rh;
+  return _rh_filter.getValue();
 }
 
 inline uint16_t SHT1X::getState() {
@@ -10,6 +10,16 @@ const long TIMEOUT = 200; // 200ms timeout
 
 const uint8_t PIN_BITS = _BV(PORTC4) | _BV(PORTC5);
 
+// poll states of the first submitted transaction, each one waits for TWINT except IDLE and STOP
+const uint8_t STATE_IDLE      = 0; // not started yet
+const uint8_t STATE_START     = 1;
+const uint8_t STATE_REP_START = 2; // before read after write
+const uint8_t STATE_SLA_W     = 3;
+const uint8_t STATE_DATA_W    = 4;
+const uint8_t STATE_SLA_R     = 5;
+const uint8_t STATE_DATA_R    = 6;
+const uint8_t STATE_STOP      = 7; // waits for TWSTO to clear
+
 // Singleton instance 
 TWIMasterClass TWIMaster; 
 
@@ -49,6 +59,11 @@ uint8_t TWIMasterClass::wait(uint8_t expected) {
       abort();
       return 0xfe; // timeout error code
     }
+  return check(expected);
+}
+
+// checks status when TWINT is set, result != 0 means error (and bus is released), error code is returned
+uint8_t TWIMasterClass::check(uint8_t expected) {
   uint8_t status = TW_STATUS;
   if (status != expected) {
 #ifdef TWI_DEBUG
@@ -73,26 +88,32 @@ uint8_t TWIMasterClass::wait(uint8_t expected) {
   return 0;
 }
 
+void TWIMasterClass::acquire() {
+  // begin on first use (init speed)
+  if (TWBR == 0)
+    begin();
+  // on first start save original TWEN, TWIE, and TWEA bits register value
+  cli();
+  _twcr = TWCR & (_BV(TWEN) | _BV(TWIE) | _BV(TWEA)); 
+  if (_twcr & _BV(TWEN)) 
+    TWCR = 0; // something was going on (because TWI was enabled) -- terminate it to reset TWI state machine
+  sei();
+  if (_twcr & _BV(TWIE)) // if interrupts were enabled, we assume that TWI slave is also working here
+    _twcr |= _BV(TWEA); // need to make sure to enable ack in restore() when we are done
+  _active = true;
+}
+
 // result != 0 means error, error code is returned
 uint8_t TWIMasterClass::start() {
+  // submitted transaction that is already on the bus goes first
+  while (_state != STATE_IDLE)
+    poll();
   bool repStart = _active;
 #ifdef TWI_DEBUG
   Serial.print(repStart ? '!' : '[');
 #endif
-  if (!repStart) {
-    // begin on first use (init speed)
-    if (TWBR == 0)
-      begin();
-    // on first start save original TWEN, TWIE, and TWEA bits register value
-    cli();
-    _twcr = TWCR & (_BV(TWEN) | _BV(TWIE) | _BV(TWEA)); 
-    if (_twcr & _BV(TWEN)) 
-      TWCR = 0; // something was going on (because TWI was enabled) -- terminate it to reset TWI state machine
-    sei();
-    if (_twcr & _BV(TWIE)) // if interrupts were enabled, we assume that TWI slave is also working here
-      _twcr |= _BV(TWEA); // need to make sure to enable ack in restore() when we are done
-    _active = true;
-  }
+  if (!repStart)
+    acquire();
   TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN); // enable & start, no interrups
   uint8_t status = wait(repStart ? TW_REP_START : TW_START);
   if (status != 0)
@@ -184,3 +205,116 @@ uint8_t TWIMasterClass::receive(uint8_t addr, void *rx, uint8_t n, bool keepBus)
     stop();
   return 0;
 }
+
+bool TWIMasterClass::submit(TWITransaction &t) {
+  if (_count == TWI_QUEUE_SIZE)
+    return false;
+  t.status = TWI_PENDING;
+  _queue[(_head + _count++) % TWI_QUEUE_SIZE] = &t;
+  return true;
+}
+
+// completes the first submitted transaction
+void TWIMasterClass::next(uint8_t status) {
+  TWITransaction &t = *_queue[_head];
+  _head = (_head + 1) % TWI_QUEUE_SIZE;
+  _count--;
+  _state = STATE_IDLE;
+  t.status = status;
+  if (t.done)
+    t.done(t);
+}
+
+bool TWIMasterClass::poll() {
+  if (_count == 0)
+    return false;
+  TWITransaction &t = *_queue[_head];
+  if (_state == STATE_IDLE) {
+    if (_active)
+      return true; // bus is kept by transmit / receive until stop
+    acquire();
+    TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN); // enable & start, no interrups
+    _state = STATE_START;
+    _index = 0;
+    _timeout.reset(TIMEOUT);
+    return true;
+  }
+  if (_state == STATE_STOP) {
+    if (TWCR & _BV(TWSTO)) {
+      if (_timeout.check()) {
+        abort();
+        next(0); // everything was transferred, just like stop
+      }
+      return true;
+    }
+    // all Ok -- restore original state
+    restore();
+    next(0);
+    return _count != 0;
+  }
+  if ((TWCR & _BV(TWINT)) == 0) {
+    if (_timeout.check()) {
+      abort();
+      next(0xfe); // timeout error code
+    }
+    return true;
+  }
+  uint8_t status;
+  switch (_state) {
+  case STATE_START:
+  case STATE_REP_START:
+    status = check(_state == STATE_START ? TW_START : TW_REP_START);
+    if (status != 0)
+      break;
+    if (_state == STATE_START && (t.txSize != 0 || t.rxSize == 0)) {
+      TWDR = (t.addr << 1) | TW_WRITE;
+      _state = STATE_SLA_W;
+    } else {
+      TWDR = (t.addr << 1) | TW_READ;
+      _state = STATE_SLA_R;
+    }
+    TWCR = _BV(TWINT) | _BV(TWEN);
+    break;
+  case STATE_SLA_W:
+  case STATE_DATA_W:
+    status = check(_state == STATE_SLA_W ? TW_MT_SLA_ACK : TW_MT_DATA_ACK);
+    if (status != 0)
+      break;
+    if (_index < t.txSize) {
+      TWDR = ((const uint8_t*)t.tx)[_index++];
+      TWCR = _BV(TWINT) | _BV(TWEN);
+      _state = STATE_DATA_W;
+    } else if (t.rxSize != 0) {
+      TWCR = _BV(TWINT) | _BV(TWSTA) | _BV(TWEN); // repeated start to read
+      _state = STATE_REP_START;
+      _index = 0;
+    } else {
+      TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+      _state = STATE_STOP;
+    }
+    break;
+  case STATE_SLA_R:
+    status = check(TW_MR_SLA_ACK);
+    if (status != 0)
+      break;
+    TWCR = _BV(TWINT) | _BV(TWEN) | (t.rxSize > 1 ? _BV(TWEA) : 0); // ack all but last byte
+    _state = STATE_DATA_R;
+    break;
+  default: // STATE_DATA_R
+    status = check(_index + 1 < t.rxSize ? TW_MR_DATA_ACK : TW_MR_DATA_NACK);
+    if (status != 0)
+      break;
+    ((uint8_t*)t.rx)[_index++] = TWDR;
+    if (_index < t.rxSize) {
+      TWCR = _BV(TWINT) | _BV(TWEN) | (_index + 1 < t.rxSize ? _BV(TWEA) : 0);
+    } else {
+      TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+      _state = STATE_STOP;
+    }
+  }
+  if (status != 0)
+    next(status); // bus was already released by check
+  else
+    _timeout.reset(TIMEOUT);
+  return true;
+}
@@ -1,6 +1,8 @@
 /*
   TWI Master implementation that is not based on interrupts and supports different speeds.
   It plays nicely with TWI Slave code (restores TWI hardware to the previous state it was initially encountered in).
+  Transactions can also be queued with submit and then run by calling poll from the loop, 
+  so that bus time overlaps with other work (poll never waits for the bus).
 
   This code works for regular Arduino Uno/Duemilanove/Pro boards only based on ATmega328p.
 
@@ -36,6 +38,25 @@ const twi_speed_t TWI_100K = 0x000 | uint8_t((F_CPU / 100000 - 16) / 2); //  10u
 
 const twi_speed_t TWI_DEFAULT_SPEED = TWI_40K; // compromise speed, 100K is a bit too fast for breadboards
 
+const uint8_t TWI_QUEUE_SIZE = 4; // max number of submitted transactions
+const uint8_t TWI_PENDING = 0xfd; // status of transaction that is queued or in progress
+
+// Asynchronous transaction: write tx (if txSize != 0 or rxSize == 0), then read rx (if rxSize != 0) 
+// with repeated start in between. It must stay in place until done.
+class TWITransaction {
+public:
+  uint8_t addr;
+  const void *tx;
+  uint8_t txSize;
+  void *rx;
+  uint8_t rxSize;
+  void (*done)(TWITransaction &t); // optional, invoked from poll when complete
+  uint8_t status; // TWI_PENDING, then 0 on success or error code as returned by transmit / receive
+
+  inline TWITransaction() : done(0), status(0) {}
+  inline bool pending() { return status == TWI_PENDING; }
+};
+
 class TWIMasterClass {
 public:
   // begin is optional, begins at first operation with default speed
@@ -48,6 +69,11 @@ public:
   // stop is optinal, transmit / receive call it when used with keepBus = false
   void stop(); 
 
+  // queues transaction, false when queue is full
+  bool submit(TWITransaction &t);
+  // advances queued transactions without waiting, true while there is something left to do
+  bool poll();
+
   // high-level convenience methods
   template<typename T> inline uint8_t transmit(uint8_t addr, const T& tx) { 
     return transmit(addr, &tx, sizeof(tx)); 
@@ -68,10 +94,21 @@ private:
   uint8_t _twcr;
   bool _active;
 
+  // submitted transactions and progress of the first one
+  TWITransaction *_queue[TWI_QUEUE_SIZE];
+  uint8_t _head;
+  uint8_t _count;
+  uint8_t _state;
+  uint8_t _index;
+  Timeout _timeout;
+
+  void acquire();
+  uint8_t check(uint8_t expected);
   uint8_t wait(uint8_t expected);
   uint8_t start();
   void abort();
   void restore();
+  void next(uint8_t status);
 };
 
 // Singleton instance 
@@ -0,0 +1,58 @@
+/*
+  Test sketch that transmits and receives in a single asynchronous transaction,
+  while led keeps blinking and loop keeps counting how many times it ran.
+*/
+
+#include <TWIMaster.h>
+#include <BlinkLed.h>
+#include <Timeout.h>
+
+const char ADDR = 'T';
+
+const uint8_t BLINK_LED_PIN = 13;
+
+BlinkLed blinkLed(BLINK_LED_PIN);
+Timeout timeout(0);
+
+long tx;
+uint8_t rx[4];
+TWITransaction txrx;
+long loops = 0;
+bool reported = true;
+
+void setup() {
+  Serial.begin(57600);
+  Serial.println(F("=== TWIMaster Async Test ==="));
+  Serial.print(F("Working with TWI address ")); Serial.println(ADDR, HEX);
+  txrx.addr = ADDR;
+  txrx.tx = &tx;
+  txrx.txSize = sizeof(tx);
+  txrx.rx = rx;
+  txrx.rxSize = sizeof(rx);
+}
+
+void loop() {
+  loops++;
+  TWIMaster.poll();
+  if (timeout.check()) {
+    tx = millis();
+    loops = 0;
+    reported = !TWIMaster.submit(txrx);
+    timeout.reset(1000);
+  }
+  if (!reported && !txrx.pending()) {
+    Serial.print(F("TxRx status: "));
+    Serial.print(txrx.status, HEX);
+    Serial.print(F(" loops while on bus: "));
+    Serial.println(loops);
+    if (txrx.status == 0) {
+      for (uint8_t i = 0; i < sizeof(rx); i++) {
+        Serial.print(' ');
+        Serial.print(rx[i], HEX);
+      }
+      Serial.println();  
+    }  
+    reported = true;
+  }
+  blinkLed.blink(txrx.status == 0 ? 1000 : 250);
+}
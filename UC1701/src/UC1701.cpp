@@ -33,6 +33,10 @@
 
 #include <avr/pgmspace.h>
 
+#ifdef __AVR__
+#include <util/atomic.h>
+#endif
+
 
 /*
  * If this was a ".h", it would get added to sketches when using
@@ -41,30 +45,84 @@
 #include "charset.cpp"
 
 
+/*
+ * Set a display pin, straight through its port register where possible
+ * (digitalWrite() takes several microseconds on AVR). The read-modify-write
+ * runs with interrupts off, so an ISR touching another pin on the same port
+ * can't have its change undone...
+ */
+#ifdef __AVR__
+#define UC1701_WRITE(pin, value) \
+    do { \
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { \
+            if (value) *this->port_##pin |= this->mask_##pin; \
+            else *this->port_##pin &= ~this->mask_##pin; \
+        } \
+    } while (0)
+#else
+#define UC1701_WRITE(pin, value) digitalWrite(this->pin_##pin, value)
+#endif
+
+// Framebuffer size: 8 pages of 128 columns, each byte 8 pixels high...
+#define UC1701_BUFFER_SIZE (128 * 8)
+
+
 UC1701::UC1701(unsigned char sclk, unsigned char sid,
                  unsigned char cs1,
                  unsigned char a0):
     pin_sclk(sclk),
     pin_sid(sid),
     pin_cs1(cs1),
-    pin_a0(a0)
+    pin_a0(a0),
+    spi(NULL),
+    buffer(NULL)
+{}
+
+UC1701::UC1701(SPIClass *spi, unsigned char cs1, unsigned char a0):
+    pin_sclk(SCK),
+    pin_sid(MOSI),
+    pin_cs1(cs1),
+    pin_a0(a0),
+    spi(spi),
+    buffer(NULL)
 {}
 
 
 
 
-void UC1701::begin()
+void UC1701::begin(bool buffered)
 {
    this->width = 128;
     this->height = 64;
 
     this->column = 0;
     this->line = 0;
+
+    // Without memory for the framebuffer, fall back to drawing directly...
+    if (buffered && !this->buffer) {
+        this->buffer = (unsigned char *)malloc(UC1701_BUFFER_SIZE);
+    }
+
     // All pins are outputs 
     pinMode(this->pin_cs1, OUTPUT);
     pinMode(this->pin_a0, OUTPUT);
-    pinMode(this->pin_sclk, OUTPUT);
-    pinMode(this->pin_sid, OUTPUT);
+    if (this->spi) {
+        this->spi->begin();
+    } else {
+        pinMode(this->pin_sclk, OUTPUT);
+        pinMode(this->pin_sid, OUTPUT);
+    }
+
+#ifdef __AVR__
+    this->port_sclk = portOutputRegister(digitalPinToPort(this->pin_sclk));
+    this->mask_sclk = digitalPinToBitMask(this->pin_sclk);
+    this->port_sid = portOutputRegister(digitalPinToPort(this->pin_sid));
+    this->mask_sid = digitalPinToBitMask(this->pin_sid);
+    this->port_cs1 = portOutputRegister(digitalPinToPort(this->pin_cs1));
+    this->mask_cs1 = digitalPinToBitMask(this->pin_cs1);
+    this->port_a0 = portOutputRegister(digitalPinToPort(this->pin_a0));
+    this->mask_a0 = digitalPinToBitMask(this->pin_a0);
+#endif
 
     // Reset the controller state...
     digitalWrite(this->pin_cs1, LOW);
@@ -93,12 +151,23 @@ void UC1701::begin()
    this->Transfer_command(0xA5); //display all points
    delay(200);
    this->Transfer_command(0xA4); //normal display
-   digitalWrite(this->pin_cs1, LOW);
+   if (!this->spi) {
+       digitalWrite(this->pin_cs1, LOW);
+   }
    this->clear();
+   this->display();
 }
 
 void UC1701::clear()
 {
+    if (this->buffer) {
+        memset(this->buffer, 0, UC1701_BUFFER_SIZE);
+        memset(this->dirty_first, 0, sizeof(this->dirty_first));
+        memset(this->dirty_last, 127, sizeof(this->dirty_last));
+        this->setCursor(0, 0);
+        return;
+    }
+
 for  (unsigned short j = 0; j < 8; j++) 
 {
     this->setCursor(0, j);
@@ -117,9 +186,18 @@ void UC1701::setCursor(unsigned char column, unsigned char line)
        this->column = column;
        this->line = line;
 
+       if (this->buffer) {
+           // Just move the framebuffer write position...
+           this->ram_column = column;
+           this->ram_line = line;
+           return;
+       }
+
        i=(column&0xF0)>>4;
        j=column&0x0F;
-       digitalWrite(this->pin_cs1, LOW);
+       if (!this->spi) {
+           digitalWrite(this->pin_cs1, LOW);
+       }
        this->Transfer_command(0xb0+line); 
        this->Transfer_command(0x10+i); 
        this->Transfer_command(j);
@@ -279,37 +357,118 @@ void UC1701::drawColumn(unsigned char lines, unsigned char value)
     this->setCursor(scolumn + 1, sline); 
 }
 
-void UC1701::Transfer_command(int data1)
+void UC1701::display()
+{
+    if (!this->buffer) {
+        return;
+    }
+
+    // One page address and one run of data per changed page...
+    for (unsigned char page = 0; page < 8; page++) {
+        unsigned char first = this->dirty_first[page];
+        unsigned char last = this->dirty_last[page];
+
+        if (first > last) {
+            continue;
+        }
+
+        // Visible columns start at controller column 4...
+        unsigned char column = first + 4;
+
+        this->select(LOW);
+        this->transfer(0xb0 + page);
+        this->transfer(0x10 + (column >> 4));
+        this->transfer(column & 0x0F);
+        UC1701_WRITE(a0, HIGH);
+
+        const unsigned char *data = this->buffer + page * 128;
+        for (unsigned char x = first; x <= last; x++) {
+            this->transfer(data[x]);
+        }
+        this->deselect();
+
+        this->dirty_first[page] = 0xFF;
+        this->dirty_last[page] = 0;
+    }
+}
+
+void UC1701::select(unsigned char level)
+{
+    if (this->spi) {
+        this->spi->beginTransaction(SPISettings(4000000, MSBFIRST, SPI_MODE0));
+    }
+    UC1701_WRITE(cs1, LOW);
+    UC1701_WRITE(a0, level);
+}
+
+void UC1701::deselect()
+{
+    // Bit-banged, the display stays selected (as it always has)...
+    if (this->spi) {
+        UC1701_WRITE(cs1, HIGH);
+        this->spi->endTransaction();
+    }
+}
+
+void UC1701::transfer(unsigned char data)
 {
+    if (this->spi) {
+        this->spi->transfer(data);
+        return;
+    }
+
+#ifdef __AVR__
+    // Each port access takes longer than the controller's minimum clock phase...
+    for (unsigned char bit = 0x80; bit; bit >>= 1) {
+        UC1701_WRITE(sclk, LOW);
+        UC1701_WRITE(sid, data & bit);
+        UC1701_WRITE(sclk, HIGH);
+    }
+#else
    char i;
-   digitalWrite(this->pin_cs1, LOW);
-   digitalWrite(this->pin_a0, LOW);
    for (i=0; i<8; i++)
                {
                  digitalWrite(this->pin_sclk, LOW);
-                 if(data1&0x80) digitalWrite(this->pin_sid, HIGH);
+                 if(data&0x80) digitalWrite(this->pin_sid, HIGH);
                  else digitalWrite(this->pin_sid, LOW);
                  delayMicroseconds(2);
                  digitalWrite(this->pin_sclk, HIGH);
                  delayMicroseconds(2);
-                 data1=data1<<1;
+                 data=data<<1;
                }
+#endif
+}
+
+void UC1701::Transfer_command(int data1)
+{
+    this->select(LOW);
+    this->transfer(data1);
+    this->deselect();
 }
 
 void UC1701::Transfer_data(int data1)
 {
-   char i;
-   digitalWrite(this->pin_cs1, LOW);
-   digitalWrite(this->pin_a0, HIGH);
-   for (i=0; i<8; i++)
-               {
-                 digitalWrite(this->pin_sclk, LOW);
-                 if(data1&0x80) digitalWrite(this->pin_sid, HIGH);
-                 else digitalWrite(this->pin_sid, LOW);
-                 delayMicroseconds(2);
-                 digitalWrite(this->pin_sclk, HIGH);
-                 delayMicroseconds(2);
-                 data1=data1<<1;
-               }
+    if (this->buffer) {
+        // Store at the write position, the controller would advance it the same way...
+        unsigned char x = this->ram_column - 4;
+
+        if (x < 128 && this->ram_line < 8) {
+            this->buffer[this->ram_line * 128 + x] = data1;
+
+            if (x < this->dirty_first[this->ram_line]) {
+                this->dirty_first[this->ram_line] = x;
+            }
+            if (x > this->dirty_last[this->ram_line]) {
+                this->dirty_last[this->ram_line] = x;
+            }
+        }
+
+        this->ram_column++;
+        return;
+    }
+
+    this->select(HIGH);
+    this->transfer(data1);
+    this->deselect();
 }
 
@@ -29,6 +29,8 @@
 #include <Arduino.h>
 #endif
 
+#include <SPI.h>
+
 
 class UC1701: public Print {
     public:
@@ -37,10 +39,18 @@ class UC1701: public Print {
                 unsigned char sid = 20,   /* data-in     (MOSI) */
                 unsigned char cs1   = 19,   /* data select (CS) */
                 unsigned char a0  = 22);  /* a0     (A0)*/
+
+        // ...or the display is wired to the hardware SPI bus (SCK and MOSI)...
+        UC1701(SPIClass *spi, unsigned char cs1, unsigned char a0);
                
 
         // Display initialization (dimensions in pixels)...
-        void begin();
+        // In buffered mode drawing goes to a 1 KB framebuffer instead,
+        // and only reaches the display on display()...
+        void begin(bool buffered = false);
+
+        // Send the framebuffer pages changed since the last call (buffered mode)...
+        void display();
 
         // Erase everything on the display...
         void clear();
@@ -79,6 +89,26 @@ class UC1701: public Print {
         unsigned char pin_cs1;
         unsigned char pin_a0;
 
+        // Hardware SPI bus, or NULL to bit-bang the pins...
+        SPIClass *spi;
+
+#ifdef __AVR__
+        // Port registers of the pins, to bit-bang without digitalWrite()...
+        volatile uint8_t *port_sclk, *port_sid, *port_cs1, *port_a0;
+        uint8_t mask_sclk, mask_sid, mask_cs1, mask_a0;
+#endif
+
+        // Framebuffer (8 pages of 128 columns), or NULL when unbuffered...
+        unsigned char *buffer;
+
+        // Framebuffer write position (controller column address and page)...
+        unsigned char ram_column;
+        unsigned char ram_line;
+
+        // Changed columns of each page not yet sent by display()...
+        unsigned char dirty_first[8];
+        unsigned char dirty_last[8];
+
         // The size of the display, in pixels...
         unsigned char width;
         unsigned char height;
@@ -90,6 +120,12 @@ class UC1701: public Print {
         // User-defined glyphs (below the ASCII space character)...
         const unsigned char *custom[' '];
 
+        // Start and end a transfer of commands (a0 = LOW) or data (a0 = HIGH)...
+        void select(unsigned char level);
+        void deselect();
+
+        // Shift one byte out to the display...
+        void transfer(unsigned char data);
 
 };
 